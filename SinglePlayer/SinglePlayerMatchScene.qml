@@ -27,6 +27,8 @@ GameScene {
     property var readinessAggregate: null
     property var bannerCollapsePromise: null
     property bool readinessLoggingEnabled: true
+    // When set, the match is recorded from seeding on and saved here on exit
+    property string replayPath: ""
 
     Component {
         id: promiseFactory
@@ -59,6 +61,14 @@ GameScene {
     property var initiativeResults: ({})
     property var initiativePromise: null
 
+    GameGridBatch {
+        id: cascadeBatch
+    }
+
+    GameReplay {
+        id: matchReplay
+    }
+
     CpuPlayerController {
         id: cpuController
         onLoadoutPrepared: function(index, loadout) {
@@ -101,7 +111,10 @@ GameScene {
 
             Button {
                 text: qsTr("Exit")
-                onClicked: scene.exitRequested()
+                onClicked: {
+                    scene._saveReplay()
+                    scene.exitRequested()
+                }
             }
 
             Item { Layout.fillWidth: true }
@@ -352,12 +365,32 @@ GameScene {
             console.debug("MatchScene", "activateFillingChain")
         const cpuBoard = _dashboardFor(0)
         const humanBoard = _dashboardFor(1)
+        // A request flag can be left over from a cascade that already
+        // finished; only batch grids whose cascade has yet to resolve
+        if (cpuBoard && humanBoard && cpuBoard.gridElement.cascadePending
+                && humanBoard.gridElement.cascadePending) {
+            // Both grids have a cascade in flight; settle them together
+            const grids = [cpuBoard.gridElement, humanBoard.gridElement]
+            const timelines = cascadeBatch.resolveCascades(grids.map(function(grid) {
+                return grid.gridOrchestrator
+            }))
+            for (let i = 0; i < grids.length; ++i)
+                grids[i].adoptCascade(timelines[i])
+        }
         if (cpuBoard)
             cpuBoard.transitionToFillingChain()
         if (humanBoard)
             humanBoard.transitionToFillingChain()
     }
 
+    function _saveReplay() {
+        if (!matchReplay.recording)
+            return
+        matchReplay.stopRecording()
+        if (!matchReplay.save(replayPath))
+            console.warn("MatchScene", "could not save replay to", replayPath)
+    }
+
     function _assignSeeds() {
         if (matchActive || seedAggregate)
             return seedAggregate
@@ -367,6 +400,10 @@ GameScene {
             console.debug("MatchScene", "assigning seeds", seeds)
         const cpuBoard = _dashboardFor(0)
         const humanBoard = _dashboardFor(1)
+        if (replayPath.length && cpuBoard && humanBoard) {
+            matchReplay.startRecording([cpuBoard.gridElement.gridOrchestrator,
+                                        humanBoard.gridElement.gridOrchestrator])
+        }
 
         const promises = []
 
@@ -579,6 +616,9 @@ GameScene {
     function _handleTurnCompleted(index) {
         if (index !== activeDashboardIndex)
             return
+        const board = _dashboardFor(index)
+        if (matchReplay.recording && board)
+            matchReplay.recordTurnEnd(board.gridElement.gridOrchestrator)
         const nextIndex = index === 0 ? 1 : 0
         if (readinessLoggingEnabled)
             console.debug("MatchScene", "turn completed", index, "->", nextIndex)
@@ -608,16 +648,23 @@ GameScene {
         const grid = board ? board.gridElement : null
         if (!grid || !grid.activeTurn || grid.swapsRemaining <= 0 || grid.gridState !== "match")
             return
-        const move = controller ? controller.selectBestSwap(grid) : null
-        if (!move) {
+        if (!controller) {
             grid.endTurnEarly()
             return
         }
         cpuThinking = true
-        const success = grid.requestSwap(move.row1, move.column1, move.row2, move.column2)
-        cpuThinking = false
-        if (!success)
-            grid.endTurnEarly()
+        controller.planSwap(grid).then(function(move) {
+            cpuThinking = false
+            if (!grid.activeTurn || grid.swapsRemaining <= 0)
+                return
+            if (!move) {
+                grid.endTurnEarly()
+                return
+            }
+            const success = grid.requestSwap(move.row1, move.column1, move.row2, move.column2)
+            if (!success)
+                grid.endTurnEarly()
+        })
     }
 
 }
@@ -9,6 +9,10 @@ Item {
     property var preparedLoadout: []
     property var linkedDashboard: null
     property var hydrationPromise: null
+    // Lookahead over this many swaps of the turn, cascades included, for at
+    // most searchBudgetMs on worker threads. 1 and 0 play the greedy swap.
+    property int lookaheadSwaps: 3
+    property int searchBudgetMs: 200
 
     signal loadoutPrepared(int dashboardIndex, var loadout)
     signal initiativeRolled(int dashboardIndex, int rollValue)
@@ -30,28 +34,25 @@ Item {
         initiativeRolled(dashboardIndex, value)
     }
 
+    function planSwap(grid) {
+        const activeGrid = grid || (linkedDashboard ? linkedDashboard.gridElement : null)
+        if (!activeGrid) {
+            const immediate = Q.promise()
+            immediate.resolve(null)
+            return immediate
+        }
+        // The policy itself (greedy or searched, how deep) lives in
+        // GridCpuPolicy so headless tournaments play exactly the same way
+        return activeGrid.planCpuSwap(lookaheadSwaps, searchBudgetMs).then(function(plan) {
+            return plan.length ? plan[0] : null
+        })
+    }
+
     function selectBestSwap(grid) {
         const activeGrid = grid || (linkedDashboard ? linkedDashboard.gridElement : null)
         if (!activeGrid)
             return null
-        const options = []
-        for (let r = 0; r < activeGrid.rowCount; ++r) {
-            for (let c = 0; c < activeGrid.columnCount; ++c) {
-                if (c + 1 < activeGrid.columnCount) {
-                    const scoreH = activeGrid.evaluateSwapPotential(r, c, r, c + 1)
-                    if (scoreH > 0)
-                        options.push({ row1: r, column1: c, row2: r, column2: c + 1, score: scoreH })
-                }
-                if (r + 1 < activeGrid.rowCount) {
-                    const scoreV = activeGrid.evaluateSwapPotential(r, c, r + 1, c)
-                    if (scoreV > 0)
-                        options.push({ row1: r, column1: c, row2: r + 1, column2: c, score: scoreV })
-                }
-            }
-        }
-        if (!options.length)
-            return null
-        options.sort(function(a, b) { return b.score - a.score })
-        return options[0]
+        const ranked = activeGrid.rankSwaps(1)
+        return ranked.length ? ranked[0] : null
     }
 }
@@ -25,6 +25,9 @@ AbstractGameElement {
     property real launchDistance: cellExtent * 0.9
     property int dropDurationMs: 160
     property int launchDurationMs: 220
+    // Tween specs resolved once; each move tweens a copy with its targets
+    property var dropSpec: block.tweenSpec({ easing: Easing.OutQuad })
+    property var launchSpec: block.tweenSpec({ opacity: 0, easing: Easing.InQuad })
 
     // Drag bookkeeping
     property bool maybeSwitching: false
@@ -157,15 +160,51 @@ AbstractGameElement {
             block.y = targetY
         }
 
-        block.propertyList = ["x", "y"]
+        const spec = block.dropSpec
+        spec.x = targetX
+        spec.y = targetY
         return Q.promise(function(resolve) {
-            const success = block.tweenPropertiesTo({
-                                                    x: targetX,
-                                                    y: targetY
-                                                }, timeMs, { type: Easing.OutQuad }, startFunc, function() {
-                                                    endFunc()
-                                                    resolve(block)
-                                                })
+            const success = block.tweenTo(spec, timeMs, startFunc, function() {
+                endFunc()
+                resolve(block)
+            })
+            if (!success) {
+                startFunc()
+                endFunc()
+                resolve(block)
+            }
+        })
+    }
+
+    // Falls row by row with the drop easing on every row, as one tween
+    function queueDropPath(fromRow, targetRow, targetColumn, stepDurationMs) {
+        const targetX = targetColumn * cellExtent + cellPadding
+        const targetY = targetRow * cellExtent + cellPadding
+        const stepMs = stepDurationMs || dropDurationMs
+        const step = targetRow > fromRow ? 1 : -1
+        const rows = Math.abs(targetRow - fromRow)
+
+        const keyframes = []
+        for (let i = 1; i <= rows; ++i)
+            keyframes.push({ y: (fromRow + step * i) * cellExtent + cellPadding, easing: Easing.OutQuad })
+
+        const startFunc = function() {
+            block.inAnimation = true
+            block.row = targetRow
+            block.column = targetColumn
+        }
+
+        const endFunc = function() {
+            block.inAnimation = false
+            block.x = targetX
+            block.y = targetY
+        }
+
+        return Q.promise(function(resolve) {
+            const success = block.tweenKeyframes(keyframes, rows * stepMs, startFunc, function() {
+                endFunc()
+                resolve(block)
+            })
             if (!success) {
                 startFunc()
                 endFunc()
@@ -191,16 +230,14 @@ AbstractGameElement {
             block.launchCompleted(block)
         }
 
-        block.propertyList = ["x", "y", "opacity"]
+        const spec = block.launchSpec
+        spec.x = targetX
+        spec.y = targetY
         return Q.promise(function(resolve) {
-            const success = block.tweenPropertiesTo({
-                                                    x: targetX,
-                                                    y: targetY,
-                                                    opacity: 0
-                                                }, timeMs, { type: Easing.InQuad }, startFunc, function() {
-                                                    endFunc()
-                                                    resolve(block)
-                                                })
+            const success = block.tweenTo(spec, timeMs, startFunc, function() {
+                endFunc()
+                resolve(block)
+            })
             if (!success) {
                 startFunc()
                 block.x = targetX
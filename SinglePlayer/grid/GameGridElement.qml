@@ -26,29 +26,56 @@ Item {
     property var _cascadePromise: null
     property var _fillStateGate: null
     property var _cascadeCompletionGate: null
+    property var _turnPlanGate: null
+    property bool _reshufflePending: false
+    property var _adoptedTimeline: null
+    // A cascade is in flight and has not resolved its timeline yet
+    property bool cascadePending: false
     property int compactionStepDurationMs: 110
+    // GridCascadeEvent::Kind values in resolveCascade() records
+    readonly property int _spawnEvent: 0
+    readonly property int _moveEvent: 1
+    readonly property int _matchEvent: 2
+    readonly property int _launchEvent: 3
     property bool stateLoggingEnabled: false
 
     signal swapPerformed(bool success, int row1, int column1, int row2, int column2)
     signal turnEnded()
     signal fillCycleStarted()
+    signal boardReshuffled()
 
     implicitWidth: 420
     implicitHeight: 420
 
+    readonly property GameGridOrchestrator gridOrchestrator: orchestrator
+
     GameGridOrchestrator {
         id: orchestrator
         rowCount: grid.rowCount
         columnCount: grid.columnCount
         fillDirection: grid.fillDirection
-    }
-
-    readonly property var colorPalette: [
-        { key: "red", hex: "#ef4444", label: qsTr("Red") },
-        { key: "green", hex: "#22c55e", label: qsTr("Green") },
-        { key: "blue", hex: "#3b82f6", label: qsTr("Blue") },
-        { key: "yellow", hex: "#facc15", label: qsTr("Yellow") }
+        spawnPalette: grid.colorPalette
+        onTurnPlanned: function(swaps, score) {
+            grid._handleTurnPlanned(swaps, score)
+        }
+        // Raised inside resolveCascade(); the swap happens once the
+        // cascade has finished playing
+        onNoMovesAvailable: grid._reshufflePending = true
+    }
+
+    // Every block color the grid can draw. colorPalette picks the ones in
+    // play; weight is the relative spawn chance (0 never spawns).
+    readonly property var availableColors: [
+        { key: "red", hex: "#ef4444", label: qsTr("Red"), weight: 1 },
+        { key: "green", hex: "#22c55e", label: qsTr("Green"), weight: 1 },
+        { key: "blue", hex: "#3b82f6", label: qsTr("Blue"), weight: 1 },
+        { key: "yellow", hex: "#facc15", label: qsTr("Yellow"), weight: 1 },
+        { key: "orange", hex: "#f97316", label: qsTr("Orange"), weight: 1 },
+        { key: "cyan", hex: "#06b6d4", label: qsTr("Cyan"), weight: 1 },
+        { key: "pink", hex: "#ec4899", label: qsTr("Pink"), weight: 1 },
+        { key: "purple", hex: "#a855f7", label: qsTr("Purple"), weight: 1 }
     ]
+    property var colorPalette: availableColors.slice(0, 4)
 
     Rectangle {
         anchors.fill: parent
@@ -156,6 +183,7 @@ Item {
                 row.push(null)
             gridMatrix.push(row)
         }
+        orchestrator.resetBoard()
         _setGridState("fill", "initialize")
         seedingFill = true
         _configureSpawnSeed(spawnSeed)
@@ -190,38 +218,7 @@ Item {
         return row >= 0 && row < rowCount
     }
 
-    function _generateBlockSpec(row, column) {
-        const avoid = _avoidColors(row, column)
-        const palette = colorPalette.filter(function(entry) {
-            return avoid.indexOf(entry.key) === -1
-        })
-        const choice = palette.length ? palette[Math.floor(Math.random() * palette.length)] : colorPalette[Math.floor(Math.random() * colorPalette.length)]
-        return {
-            colorKey: choice.key,
-            colorHex: choice.hex,
-            hp: 10
-        }
-    }
-
-    function _avoidColors(row, column) {
-        const avoid = []
-        if (column >= 2) {
-            const left1 = gridMatrix[row][column - 1]
-            const left2 = gridMatrix[row][column - 2]
-            if (left1 && left2 && left1.colorKey === left2.colorKey)
-                avoid.push(left1.colorKey)
-        }
-        if (row >= 2) {
-            const up1 = gridMatrix[row - 1][column]
-            const up2 = gridMatrix[row - 2][column]
-            if (up1 && up2 && up1.colorKey === up2.colorKey)
-                avoid.push(up1.colorKey)
-        }
-        return avoid
-    }
-
-    function _createBlock(row, column, specification, animate) {
-        const spec = specification || _generateBlockSpec(row, column)
+    function _createBlock(row, column, spec, animate) {
         const block = blockComponent.createObject(gridLayer, {
             row: row,
             column: column,
@@ -298,129 +295,200 @@ Item {
         return _resolvedPromise(block)
     }
 
-    function _scanVacancies() {
-        if (rowCount <= 0 || columnCount <= 0)
-            return _resolvedPromise([])
-
-        const edgeRow = _frontRowIndex()
-        const spawnRow = _spawnRowIndex()
-        const matrix = _colorMatrix()
-        const vacancies = []
-
-        for (let column = 0; column < columnCount; ++column) {
-            if (gridMatrix[edgeRow][column])
-                continue
-
-            const spec = orchestrator.spawnSpecFor(matrix, edgeRow, column)
-            if (!spec || !spec.colorKey)
-                continue
-
-            matrix[edgeRow][column] = spec.colorKey
-            vacancies.push({
-                              column: column,
-                              targetRow: edgeRow,
-                              spawnRow: spawnRow,
-                              spec: spec
-                          })
-        }
-
-        return _resolvedPromise(vacancies)
+    // Hands the cascade in flight a timeline already resolved on the
+    // orchestrator, e.g. by a GameGridBatch covering several grids. Ignored
+    // unless the cascade is still waiting to resolve.
+    function adoptCascade(timeline) {
+        if (!cascadePending)
+            return false
+        _adoptedTimeline = timeline
+        return true
     }
 
-    function _spawnBlocksForVacancies(vacancies) {
-        if (!vacancies || !vacancies.length)
-            return _resolvedPromise([])
-
-        const staged = []
-        for (let i = 0; i < vacancies.length; ++i) {
-            const vacancy = vacancies[i]
-            if (!vacancy || gridMatrix[vacancy.targetRow][vacancy.column])
-                continue
-
-            const block = _createBlock(vacancy.spawnRow, vacancy.column, vacancy.spec, false)
-            if (!block)
-                continue
-
-            block.interactionEnabled = false
-            block.allowSwitch = false
-            block.updateVisualState("idle")
+    function _playCascade() {
+        return _waitForAnimationsToSettle().then(function() {
+            const timeline = _adoptedTimeline !== null ? _adoptedTimeline : orchestrator.resolveCascade()
+            _adoptedTimeline = null
+            cascadePending = false
+            return _playTimeline(timeline)
+        }).then(function() {
+            _finishCascade()
+            return false
+        })
+    }
 
-            staged.push({
-                            block: block,
-                            targetRow: vacancy.targetRow,
-                            column: vacancy.column
-                        })
+    function _playTimeline(timeline) {
+        // resolveCascade packs { step, kind, row, column, value } records;
+        // events sharing a step play together and every step holds one kind
+        let chain = _resolvedPromise(false)
+        let index = 0
+        while (index + 4 < timeline.length) {
+            const step = timeline[index]
+            const events = []
+            while (index + 4 < timeline.length && timeline[index] === step) {
+                events.push({
+                                kind: timeline[index + 1],
+                                row: timeline[index + 2],
+                                column: timeline[index + 3],
+                                value: timeline[index + 4]
+                            })
+                index += 5
+            }
+            chain = chain.then(function() {
+                return _playStep(events)
+            })
         }
-
-        return _resolvedPromise(staged)
+        return chain
     }
 
-    function _dropStagedBlocks(stagedEntries) {
-        if (!stagedEntries || !stagedEntries.length)
+    function _playStep(events) {
+        switch (events[0].kind) {
+        case _spawnEvent:
+            return _playSpawns(events)
+        case _moveEvent:
+            return _playMoves(events)
+        case _matchEvent:
+            return _playMatches(events)
+        case _launchEvent:
+            return _playLaunches(events)
+        default:
             return _resolvedPromise(false)
+        }
+    }
 
+    function _playSpawns(events) {
+        _setGridState("fill", "timelineSpawn")
+        const spawnRow = _spawnRowIndex()
+        const paletteKeys = orchestrator.paletteKeys
+        const paletteColors = orchestrator.paletteColors
         const promises = []
-        for (let i = 0; i < stagedEntries.length; ++i) {
-            const entry = stagedEntries[i]
-            if (!entry || !entry.block)
+        for (let i = 0; i < events.length; ++i) {
+            const targetRow = events[i].row
+            const column = events[i].column
+            const color = events[i].value
+            const block = _createBlock(spawnRow, column, {
+                                           colorKey: paletteKeys[color],
+                                           colorHex: paletteColors[color],
+                                           hp: orchestrator.spawnHp
+                                       }, false)
+            if (!block)
                 continue
-
-            const targetRow = entry.targetRow
-            const column = entry.column
-            const dropPromise = entry.block.queueDropTo(targetRow, column, entry.block.dropDurationMs).then(function(instance) {
-                if (targetRow >= 0 && targetRow < rowCount && column >= 0 && column < columnCount)
-                    gridMatrix[targetRow][column] = instance
+            block.interactionEnabled = false
+            block.allowSwitch = false
+            gridMatrix[targetRow][column] = block
+            promises.push(block.queueDropTo(targetRow, column, block.dropDurationMs).then(function(instance) {
                 instance.interactionEnabled = allowPointerSwaps && activeTurn
                 instance.allowSwitch = allowPointerSwaps && activeTurn
                 instance.updateVisualState("idle")
                 return instance
-            })
-
-            promises.push(dropPromise)
+            }))
         }
-
-        if (!promises.length)
-            return _resolvedPromise(false)
-
-        return Q.all(promises).then(function() { return true; })
+        return Q.all(promises)
     }
 
-    function _fillColumns() {
-        return _scanVacancies().then(function(vacancies) {
-            if (!vacancies || !vacancies.length)
-                return false
-            return _spawnBlocksForVacancies(vacancies).then(function(staged) {
-                if (!staged || !staged.length)
-                    return false
-                return _dropStagedBlocks(staged)
-            })
+    function _playMoves(events) {
+        _setGridState("compact", "timelineMove")
+        // Lift every moving block before placing any, so moves that share a
+        // column never overwrite each other in gridMatrix.
+        const blocks = []
+        for (let i = 0; i < events.length; ++i) {
+            const event = events[i]
+            blocks.push(gridMatrix[event.row][event.column])
+            gridMatrix[event.row][event.column] = null
+        }
+        const promises = []
+        for (let i = 0; i < events.length; ++i) {
+            const event = events[i]
+            const block = blocks[i]
+            if (!block)
+                continue
+            gridMatrix[event.value][event.column] = block
+            promises.push(_moveBlockStepwise(block, event.row, event.value, event.column))
+        }
+        return Q.all(promises).then(function() {
+            _syncBlockInteractivity()
+            return true
         })
     }
 
-    function _edgeVacanciesExist() {
-        if (rowCount <= 0 || columnCount <= 0)
-            return false
-        const edgeRow = _frontRowIndex()
-        for (let column = 0; column < columnCount; ++column) {
-            if (!gridMatrix[edgeRow][column])
+    function _playMatches(events) {
+        _setGridState("match", "timelineMatch")
+        _clearSelection()
+        const blocks = []
+        for (let i = 0; i < events.length; ++i) {
+            const block = _blockAt(events[i].row, events[i].column)
+            if (block)
+                blocks.push(block)
+        }
+        matchList = blocks
+        return _resolvedPromise(true)
+    }
+
+    function _playLaunches(events) {
+        _setGridState("launch", "timelineLaunch")
+        matchList = []
+        const launches = []
+        for (let i = 0; i < events.length; ++i) {
+            const block = _blockAt(events[i].row, events[i].column)
+            if (!block)
+                continue
+            gridMatrix[events[i].row][events[i].column] = null
+            // Matches left over from the seeding fill vanish without a launch
+            if (seedingFill) {
+                block.destroy()
+                continue
+            }
+            launches.push(block.launch().then(function() {
+                block.destroy()
                 return true
+            }))
         }
-        return false
+        if (!launches.length)
+            return _resolvedPromise(true)
+        return Q.all(launches)
     }
 
-    function _gridHasEmptyRow() {
+    function _finishCascade() {
+        _clearSelection()
+        if (_reshufflePending)
+            _applyReshuffle()
+        matchList = []
+        _setGridState("idle", "noMatches")
+        if (seedingFill)
+            seedingFill = false
+        _resolveCascadeCompletion({ state: "idle" })
+        _cascadeInFlight = false
+        cascadePending = false
+        _adoptedTimeline = null
+        _onCascadeComplete()
+    }
+
+    function _applyReshuffle() {
+        _reshufflePending = false
+        // reshuffle packs { row, column, color } triplets for every cell
+        _rebuildBlocks(orchestrator.reshuffle())
+        boardReshuffled()
+    }
+
+    function _rebuildBlocks(cells) {
         for (let r = 0; r < rowCount; ++r) {
-            let occupied = false
             for (let c = 0; c < columnCount; ++c) {
-                if (gridMatrix[r][c]) {
-                    occupied = true
-                    break
-                }
+                if (gridMatrix[r][c])
+                    gridMatrix[r][c].destroy()
+                gridMatrix[r][c] = null
             }
-            if (!occupied)
-                return true
         }
-        return false
+        const paletteKeys = orchestrator.paletteKeys
+        const paletteColors = orchestrator.paletteColors
+        for (let i = 0; i + 2 < cells.length; i += 3) {
+            if (cells[i + 2] < 0)
+                continue
+            gridMatrix[cells[i]][cells[i + 1]] = _createBlock(cells[i], cells[i + 1], {
+                                                                  colorKey: paletteKeys[cells[i + 2]],
+                                                                  colorHex: paletteColors[cells[i + 2]],
+                                                                  hp: orchestrator.spawnHp
+                                                              }, false)
+        }
     }
 
     function _moveBlockStepwise(block, fromRow, toRow, column) {
@@ -435,276 +503,53 @@ Item {
             return _resolvedPromise(false)
         }
 
-        const step = target > start ? 1 : -1
-        let moved = false
-        let chain = _resolvedPromise(false)
-
         block.interactionEnabled = false
         block.allowSwitch = false
+        block.setGridGeometry(cellSize, cellPadding)
+        block.x = column * cellSize + cellPadding
 
-        for (let row = start; row !== target; row += step) {
-            const nextRow = row + step
-            chain = chain.then(function() {
-                if (!Qt.isQtObject(block))
-                    return false
-                gridMatrix[row][column] = null
-                return _positionBlock(block, nextRow, column, true, compactionStepDurationMs).then(function() {
-                    if (!Qt.isQtObject(block))
-                        return false
-                    gridMatrix[nextRow][column] = block
-                    moved = true
-                    return true
-                })
-            })
-        }
-
-        return chain.then(function() {
+        return block.queueDropPath(start, target, column, compactionStepDurationMs).then(function() {
             if (Qt.isQtObject(block)) {
                 block.interactionEnabled = allowPointerSwaps && activeTurn
                 block.allowSwitch = allowPointerSwaps && activeTurn
                 block.updateVisualState("idle")
             }
-            return moved
-        })
-    }
-
-    function _compactColumnMoves(column, moveList) {
-        if (!moveList || !moveList.length)
-            return _resolvedPromise(false)
-
-        let chain = _resolvedPromise(false)
-        let movedAny = false
-
-        for (let i = 0; i < moveList.length; ++i) {
-            const move = moveList[i]
-            const fromRow = Number(move.fromRow !== undefined ? move.fromRow : move["fromRow"])
-            const toRow = Number(move.toRow !== undefined ? move.toRow : move["toRow"])
-            if (!isFinite(fromRow) || !isFinite(toRow))
-                continue
-
-            chain = chain.then(function() {
-                const block = _blockAt(fromRow, column)
-                if (!Qt.isQtObject(block))
-                    return false
-                return _moveBlockStepwise(block, fromRow, toRow, column).then(function(stepMoved) {
-                    movedAny = movedAny || stepMoved
-                    return true
-                })
-            })
-        }
-
-        return chain.then(function() {
-            return movedAny
+            return true
         })
     }
 
-    function _preCompressColumns() {
-        if (rowCount <= 0 || columnCount <= 0)
-            return _resolvedPromise(false)
-
-        const moves = orchestrator.compactionMoves(_colorMatrix())
-        if (!moves || !moves.length) {
-            _syncBlockInteractivity()
-            return _resolvedPromise(false)
-        }
-
-        const columnMoves = {}
-        for (let i = 0; i < moves.length; ++i) {
-            const move = moves[i]
-            const column = Number(move.column !== undefined ? move.column : move["column"])
-            if (!isFinite(column))
-                continue
-            if (!columnMoves[column])
-                columnMoves[column] = []
-            columnMoves[column].push(move)
-        }
-
-        const orderedColumns = Object.keys(columnMoves).map(function(entry) {
-            return Number(entry)
-        }).sort(function(a, b) {
-            return a - b
-        })
-
-        let chain = _resolvedPromise(false)
-        let movedAny = false
-
-        for (let idx = 0; idx < orderedColumns.length; ++idx) {
-            const column = orderedColumns[idx]
-            const moveList = columnMoves[column]
-            if (!moveList || !moveList.length)
-                continue
-
-            moveList.sort(function(a, b) {
-                const first = Number(a.toRow !== undefined ? a.toRow : a["toRow"])
-                const second = Number(b.toRow !== undefined ? b.toRow : b["toRow"])
-                if (fillDirection >= 0)
-                    return second - first
-                return first - second
-            })
-
-            chain = chain.then(function() {
-                return _compactColumnMoves(column, moveList).then(function(columnMoved) {
-                    movedAny = movedAny || columnMoved
-                    return true
-                })
-            })
-        }
-
-        return chain.then(function() {
-            _syncBlockInteractivity()
-            return movedAny
-        })
-    }
-
-    function _appendHorizontalRuns(matrix, seen, coordinates) {
-        if (!matrix || !matrix.length)
-            return
-
-        const rows = matrix.length
-        const columns = matrix[0] ? matrix[0].length : 0
-
-        for (let row = 0; row < rows; ++row) {
-            let run = []
-            let lastKey = ""
-            for (let column = 0; column < columns; ++column) {
-                const key = matrix[row][column] || ""
-                if (key && key === lastKey)
-                    run.push({ row: row, column: column })
-                else {
-                    _commitRun(run, seen, coordinates)
-                    run = key ? [{ row: row, column: column }] : []
-                    lastKey = key
-                }
-            }
-            _commitRun(run, seen, coordinates)
-        }
-    }
-
-    function _appendVerticalRuns(matrix, seen, coordinates) {
-        if (!matrix || !matrix.length)
-            return
-
-        const rows = matrix.length
-        const columns = matrix[0] ? matrix[0].length : 0
-
-        for (let column = 0; column < columns; ++column) {
-            let run = []
-            let lastKey = ""
-            for (let row = 0; row < rows; ++row) {
-                const key = matrix[row][column] || ""
-                if (key && key === lastKey)
-                    run.push({ row: row, column: column })
-                else {
-                    _commitRun(run, seen, coordinates)
-                    run = key ? [{ row: row, column: column }] : []
-                    lastKey = key
-                }
-            }
-            _commitRun(run, seen, coordinates)
-        }
-    }
-
-    function _commitRun(run, seen, coordinates) {
-        if (!run || run.length < 3)
-            return
-        for (let idx = 0; idx < run.length; ++idx) {
-            const coordinate = run[idx]
-            const key = coordinate.row + ":" + coordinate.column
-            if (seen[key])
-                continue
-            seen[key] = true
-            coordinates.push(coordinate)
-        }
-    }
-
-    function _coordinatesToBlocks(coordinates) {
+    function _detectMatches() {
+        // boardMatches packs one { row, column, color } triplet per matched cell
+        const matches = orchestrator.boardMatches()
         const blocks = []
-        for (let i = 0; i < coordinates.length; ++i) {
-            const coordinate = coordinates[i]
-            const block = _blockAt(coordinate.row, coordinate.column)
-            if (block && blocks.indexOf(block) === -1)
+        for (let i = 0; i + 2 < matches.length; i += 3) {
+            const block = _blockAt(matches[i], matches[i + 1])
+            if (block)
                 blocks.push(block)
         }
         return blocks
     }
 
-    function _detectMatches() {
-        const matrix = _colorMatrix()
-        const seen = {}
-        const coordinates = []
-        _appendHorizontalRuns(matrix, seen, coordinates)
-        _appendVerticalRuns(matrix, seen, coordinates)
-        return _coordinatesToBlocks(coordinates)
-    }
-
-    function _detectMatchesAsync() {
-        const matrix = _colorMatrix()
-        const seen = {}
-        const coordinates = []
-
-        return Q.promise(function(resolve) {
-            _appendHorizontalRuns(matrix, seen, coordinates)
-            Qt.callLater(function() {
-                _appendVerticalRuns(matrix, seen, coordinates)
-                resolve(_coordinatesToBlocks(coordinates))
+    function matchShapes() {
+        // boardMatchShapes packs one { shape, color, size, length, top, left,
+        // bottom, right } record per connected group of matched cells
+        const kinds = ["line", "l", "t", "cross", "cluster"]
+        const keys = orchestrator.paletteKeys
+        const packed = orchestrator.boardMatchShapes()
+        const shapes = []
+        for (let i = 0; i + 7 < packed.length; i += 8) {
+            shapes.push({
+                shape: kinds[packed[i]],
+                color: keys[packed[i + 1]],
+                size: packed[i + 2],
+                length: packed[i + 3],
+                top: packed[i + 4],
+                left: packed[i + 5],
+                bottom: packed[i + 6],
+                right: packed[i + 7]
             })
-        })
-    }
-
-    function _launchMatches() {
-        if (!matchList || matchList.length === 0)
-            return _resolvedPromise(false)
-
-        const launchingBlocks = matchList.slice()
-        matchList = []
-
-        return Q.promise(function(resolve) {
-            const launches = []
-            for (let i = 0; i < launchingBlocks.length; ++i) {
-                const block = launchingBlocks[i]
-                if (!block)
-                    continue
-                const row = block.row
-                const column = block.column
-                if (row >= 0 && row < rowCount && column >= 0 && column < columnCount)
-                    gridMatrix[row][column] = null
-                const launchPromise = block.launch().then(function() {
-                    block.destroy()
-                    return true
-                })
-                launches.push(launchPromise)
-            }
-
-            if (!launches.length) {
-                resolve(true)
-                return
-            }
-
-            resolve(Q.all(launches))
-        })
-    }
-
-    function _processMatches(matches) {
-        _clearSelection()
-        if (matches && matches.length > 0) {
-            matchList = matches
-            if (seedingFill) {
-                return _consumeSeedMatches().then(function() {
-                    _setGridState("compact", "seededMatchConsumed")
-                    return _advanceStateMachine()
-                })
-            }
-            _setGridState("launch", "matchesReady")
-            return _advanceStateMachine()
         }
-        matchList = []
-        _setGridState("idle", "noMatches")
-        if (seedingFill)
-            seedingFill = false
-        _resolveCascadeCompletion({ state: "idle" })
-        _cascadeInFlight = false
-        _onCascadeComplete()
-        return _resolvedPromise(false)
+        return shapes
     }
 
     function _adjacentCells(r1, c1, r2, c2) {
@@ -722,6 +567,7 @@ Item {
         const second = gridMatrix[row2][column2]
         gridMatrix[row1][column1] = second
         gridMatrix[row2][column2] = first
+        orchestrator.applySwap(row1, column1, row2, column2)
         if (first)
             _positionBlock(first, row2, column2, animate)
         if (second)
@@ -743,14 +589,85 @@ Item {
         }
     }
 
+    // Board snapshots share unchanged cells natively; restoring one rebuilds
+    // the blocks from it and keeps the snapshot for further undos
+    function snapshot() {
+        return orchestrator.snapshot()
+    }
+
+    function restoreSnapshot(id) {
+        if (_cascadeInFlight || _hasActiveAnimations())
+            return false
+        const cells = orchestrator.restore(id)
+        if (!cells.length)
+            return false
+        _clearSelection()
+        _rebuildBlocks(cells)
+        return true
+    }
+
+    function releaseSnapshot(id) {
+        orchestrator.releaseSnapshot(id)
+    }
+
     function evaluateSwapPotential(row1, column1, row2, column2) {
         if (!_adjacentCells(row1, column1, row2, column2))
             return 0
-        const matrix = _colorMatrix()
-        const temp = matrix[row1][column1]
-        matrix[row1][column1] = matrix[row2][column2]
-        matrix[row2][column2] = temp
-        return _countMatchesInMatrix(matrix)
+        return orchestrator.swapScore(row1, column1, row2, column2)
+    }
+
+    function planTurn(swapCount, budgetMs) {
+        // Superseded plans resolve empty; the orchestrator drops their result
+        if (_turnPlanGate)
+            _turnPlanGate.resolve([])
+        const gate = Q.promise()
+        _turnPlanGate = gate
+        orchestrator.planTurn(swapCount, budgetMs)
+        return gate
+    }
+
+    function planCpuSwap(lookaheadSwaps, budgetMs) {
+        if (_turnPlanGate)
+            _turnPlanGate.resolve([])
+        const gate = Q.promise()
+        _turnPlanGate = gate
+        // A greedy policy resolves the gate before this returns
+        orchestrator.planCpuSwap(lookaheadSwaps, budgetMs, swapsRemaining)
+        return gate
+    }
+
+    function _handleTurnPlanned(swaps, score) {
+        const gate = _turnPlanGate
+        _turnPlanGate = null
+        if (!gate)
+            return
+        // turnPlanned packs { row1, column1, row2, column2 } records in play order
+        const plan = []
+        for (let i = 0; i + 3 < swaps.length; i += 4) {
+            plan.push({
+                          row1: swaps[i],
+                          column1: swaps[i + 1],
+                          row2: swaps[i + 2],
+                          column2: swaps[i + 3]
+                      })
+        }
+        gate.resolve(plan)
+    }
+
+    function rankSwaps(limit) {
+        // rankSwaps packs { row1, column1, row2, column2, score } records, best first
+        const packed = orchestrator.rankSwaps(limit)
+        const swaps = []
+        for (let i = 0; i + 4 < packed.length; i += 5) {
+            swaps.push({
+                           row1: packed[i],
+                           column1: packed[i + 1],
+                           row2: packed[i + 2],
+                           column2: packed[i + 3],
+                           score: packed[i + 4]
+                       })
+        }
+        return swaps
     }
 
     function endTurnEarly() {
@@ -912,6 +829,7 @@ Item {
         neighbor.z = Math.max(neighbor.z || 0, ctx.block.z)
         gridMatrix[ctx.originRow][ctx.originColumn] = neighbor
         gridMatrix[targetRow][targetColumn] = ctx.block
+        orchestrator.applySwap(ctx.originRow, ctx.originColumn, targetRow, targetColumn)
         _positionBlock(ctx.block, targetRow, targetColumn, true)
         _positionBlock(neighbor, ctx.originRow, ctx.originColumn, true)
     }
@@ -923,6 +841,7 @@ Item {
         if (neighbor) {
             gridMatrix[ctx.neighborRow][ctx.neighborColumn] = neighbor
             gridMatrix[ctx.originRow][ctx.originColumn] = ctx.block
+            orchestrator.applySwap(ctx.originRow, ctx.originColumn, ctx.neighborRow, ctx.neighborColumn)
             _positionBlock(neighbor, ctx.neighborRow, ctx.neighborColumn, animate === undefined ? false : animate)
         } else {
             gridMatrix[ctx.originRow][ctx.originColumn] = ctx.block
@@ -993,88 +912,9 @@ Item {
         }
     }
 
-    function _consumeSeedMatches() {
-        if (!matchList || !matchList.length)
-            return _resolvedPromise()
-        for (let i = 0; i < matchList.length; ++i) {
-            const block = matchList[i]
-            if (!block)
-                continue
-            const row = block.row
-            const column = block.column
-            if (row >= 0 && row < rowCount && column >= 0 && column < columnCount)
-                gridMatrix[row][column] = null
-            block.destroy()
-        }
-        matchList = []
-        return _resolvedPromise()
-    }
-
     function _configureSpawnSeed(seedValue) {
         orchestrator.spawnSeed = (Number(seedValue) >>> 0) || 1
-        orchestrator.resetPool()
-    }
-
-    function _colorMatrix() {
-        const matrix = []
-        for (let r = 0; r < rowCount; ++r) {
-            const row = []
-            for (let c = 0; c < columnCount; ++c) {
-                const block = gridMatrix[r][c]
-                row.push(block ? block.colorKey : "")
-            }
-            matrix.push(row)
-        }
-        return matrix
-    }
-
-    function _countMatchesInMatrix(matrix) {
-        const seen = {}
-        // Horizontal
-        for (let r = 0; r < rowCount; ++r) {
-            let run = []
-            let lastKey = null
-            for (let c = 0; c < columnCount; ++c) {
-                const key = matrix[r][c]
-                if (key && key === lastKey)
-                    run.push({ row: r, column: c })
-                else {
-                    if (run.length >= 3)
-                        _recordMatch(run, seen)
-                    run = key ? [{ row: r, column: c }] : []
-                    lastKey = key
-                }
-            }
-            if (run.length >= 3)
-                _recordMatch(run, seen)
-        }
-        // Vertical
-        for (let c = 0; c < columnCount; ++c) {
-            let run = []
-            let lastKey = null
-            for (let r = 0; r < rowCount; ++r) {
-                const key = matrix[r][c]
-                if (key && key === lastKey)
-                    run.push({ row: r, column: c })
-                else {
-                    if (run.length >= 3)
-                        _recordMatch(run, seen)
-                    run = key ? [{ row: r, column: c }] : []
-                    lastKey = key
-                }
-            }
-            if (run.length >= 3)
-                _recordMatch(run, seen)
-        }
-        return Object.keys(seen).length
-    }
-
-    function _recordMatch(run, store) {
-        for (let i = 0; i < run.length; ++i) {
-            const coord = run[i]
-            const key = coord.row + ":" + coord.column
-            store[key] = true
-        }
+        orchestrator.rewindSpawns()
     }
 
     function _hasActiveAnimations() {
@@ -1098,76 +938,17 @@ Item {
         })
     }
 
-    function _resolveFillState() {
-        _setGridState("fill", "resolveFillState")
-        return _fillColumns().then(function() {
-            return _enterCompactState()
-        })
-    }
-
-    function _enterCompactState() {
-        _setGridState("compact", "enterCompactState")
-        return _resolveCompactState()
-    }
-
-    function _resolveCompactState() {
-        _setGridState("compact", "resolveCompactState")
-        return _preCompressColumns().then(function() {
-            if (_edgeVacanciesExist()) {
-                _setGridState("fill", "edgeVacanciesExist")
-                return _advanceStateMachine()
-            }
-            _setGridState("match", "compactionComplete")
-            return _advanceStateMachine()
-        })
-    }
-
-    function _resolveMatchState() {
-        _setGridState("match", "resolveMatchState")
-        return _waitForAnimationsToSettle().then(function() {
-            if (_gridHasEmptyRow()) {
-                _setGridState("fill", "gridHasEmptyRow")
-                return _advanceStateMachine()
-            }
-            return _detectMatchesAsync().then(function(matches) {
-                const resolvedMatches = matches || []
-                matchList = resolvedMatches
-                return _processMatches(resolvedMatches)
-            })
-        })
-    }
-
-    function _resolveLaunchState() {
-        _setGridState("launch", "resolveLaunchState")
-        return _launchMatches().then(function() {
-            return _enterCompactState()
-        })
-    }
-
-    function _advanceStateMachine() {
-        switch (gridState) {
-        case "fill":
-            return _resolveFillState()
-        case "compact":
-            return _resolveCompactState()
-        case "match":
-            return _resolveMatchState()
-        case "launch":
-            return _resolveLaunchState()
-        default:
-            return _resolvedPromise(false)
-        }
-    }
-
     function _requestCascade() {
         if (_cascadeInFlight)
             return _cascadePromise || _resolvedPromise(false)
 
         _cascadeCompletionGate = Q.promise()
         _cascadeInFlight = true
+        _adoptedTimeline = null
+        cascadePending = true
         fillCycleStarted()
 
-        const cascade = _advanceStateMachine()
+        const cascade = _playCascade()
         _cascadePromise = cascade.then(function(result) {
             _cascadeInFlight = false
             _cascadePromise = null
@@ -1176,6 +957,8 @@ Item {
             return result
         }, function(error) {
             _cascadeInFlight = false
+            cascadePending = false
+            _adoptedTimeline = null
             _cascadePromise = null
             _rejectCascadeCompletion(error)
             console.error("Cascade sequence rejected", error)
@@ -5,6 +5,11 @@
 #include "src/gamescene.h"
 #include "src/gamesignal.h"
 #include "src/gamegridorchestrator.h"
+#include "src/gamegridbatch.h"
+#include "src/gamereplay.h"
+#include "src/gametweenspec.h"
+#include "src/gridboard.h"
+#include "src/gridinstructions.h"
 #include <QResource>
 #include <QDir>
 
@@ -26,6 +31,16 @@ int main(int argc, char *argv[])
      qmlRegisterType<GameScene>("Blockwars24", 1, 0, "GameScene");
      qmlRegisterType<GameSignal>("Blockwars24", 1, 0, "GameSignal");
     qmlRegisterType<GameGridOrchestrator>("Blockwars24", 1, 0, "GameGridOrchestrator");
+    qmlRegisterType<GameGridBatch>("Blockwars24", 1, 0, "GameGridBatch");
+    qmlRegisterType<GameReplay>("Blockwars24", 1, 0, "GameReplay");
+    qRegisterMetaType<TweenSpec>("TweenSpec");
+    qRegisterMetaType<GridBoard>("GridBoard");
+    qRegisterMetaType<GridMove>("GridMove");
+    qRegisterMetaType<GridSpawn>("GridSpawn");
+    qRegisterMetaType<GridMatch>("GridMatch");
+    qRegisterMetaType<GridSwap>("GridSwap");
+    qRegisterMetaType<GridCascadeEvent>("GridCascadeEvent");
+    qRegisterMetaType<GridMatchShape>("GridMatchShape");
     QObject::connect(
         &engine,
         &QQmlApplicationEngine::objectCreationFailed,
@@ -1,10 +1,13 @@
 #include "abstractgameelement.h"
+#include "gameeasing.h"
+#include "gameframescheduler.h"
+#include "gametweenengine.h"
 
-#include <QParallelAnimationGroup>
-#include <QPropertyAnimation>
 #include <QEasingCurve>
+#include <QHash>
 #include <QQmlEngine>
 #include <QJSEngine>
+#include <QJSValueIterator>
 #include <QJSValueList>
 #include <QMetaProperty>
 #include <QQuickWindow>
@@ -12,7 +15,6 @@
 #include <QVariant>
 #include <QPointer>
 #include <QKeyValueIterator>
-#include <QJsonObject>
 #include <QDebug>
 #include <QQuickItem>
 
@@ -25,12 +27,8 @@ AbstractGameElement::AbstractGameElement(QQuickItem* parent)
 
 AbstractGameElement::~AbstractGameElement()
 {
-    // Ensure any running animations are cleaned up
-    if (m_animGroup) {
-        m_animGroup->stop();
-        m_animGroup->deleteLater();
-        m_animGroup = nullptr;
-    }
+    // A running tween is dropped by GameTweenEngine on its next tick, once
+    // it sees the target is gone; its end callback never runs.
 }
 
 void AbstractGameElement::componentComplete()
@@ -38,6 +36,15 @@ void AbstractGameElement::componentComplete()
     QQuickItem::componentComplete();
 }
 
+QJSValue AbstractGameElement::jsWrapper()
+{
+    if (m_jsWrapper.isUndefined()) {
+        if (QQmlEngine* engine = qmlEngine(this))
+            m_jsWrapper = engine->newQObject(this);
+    }
+    return m_jsWrapper;
+}
+
 void AbstractGameElement::setPropertyList(const QStringList& props)
 {
     if (m_propertyList == props) return;
@@ -59,6 +66,13 @@ void AbstractGameElement::setExecutionQueuePaused(bool paused)
     emit executionQueuePausedChanged();
 }
 
+void AbstractGameElement::setExecutionQueuePriority(int priority)
+{
+    if (m_executionQueuePriority == priority) return;
+    m_executionQueuePriority = priority;
+    emit executionQueuePriorityChanged();
+}
+
 // ----------------------- Helpers -----------------------
 
 bool AbstractGameElement::isScalar(const QJSValue& v)
@@ -73,140 +87,89 @@ QVariant AbstractGameElement::toVariant(const QJSValue& v)
 
 QVariantMap AbstractGameElement::toVariantMap(const QJSValue& v)
 {
-    QVariantMap out;
-    if (!v.isObject()) return out;
-    QJsonObject obj = v.toVariant().toJsonObject();
-    out = obj.toVariantMap();
-
-    return out;
-}
-
-bool AbstractGameElement::hasWritableProperty(QObject* obj, const QByteArray& name, QVariant::Type* typeOut) const
-{
-    const QMetaObject* mo = obj->metaObject();
-    int idx = mo->indexOfProperty(name.constData());
-    if (idx < 0) return false;
-    QMetaProperty mp = mo->property(idx);
-    if (!mp.isWritable()) return false;
-    if (typeOut) *typeOut = static_cast<QVariant::Type>(mp.typeId());
-    return true;
-}
-
-QEasingCurve AbstractGameElement::easingFromQJSValue(const QJSValue& v) const
-{
-    // If it's a number, assume QEasingCurve::Type
-    if (v.isNumber())
-        return QEasingCurve(static_cast<QEasingCurve::Type>(v.toInt()));
-
-    // If it's an object, accept .easing or .type
-    if (v.isObject()) {
-        QJSValue ev = v.property("easing");
-        if (!ev.isUndefined())
-            return easingFromQJSValue(ev);
-
-        QJSValue tv = v.property("type");
-        if (!tv.isUndefined())
-            return easingFromQJSValue(tv);
-    }
-
-    // Strings like "linear", "InOutQuad", or "Easing.Linear"
-    QString name = v.toString().trimmed();
-    if (name.startsWith("Easing.", Qt::CaseInsensitive))
-        name = name.mid(QStringLiteral("Easing.").size());
-    name = name.toLower();
-
-    static const QHash<QString, QEasingCurve::Type> map = {
-                                                           {"linear", QEasingCurve::Linear},
-                                                           {"inquad", QEasingCurve::InQuad}, {"outquad", QEasingCurve::OutQuad}, {"inoutquad", QEasingCurve::InOutQuad},
-                                                           {"incubic", QEasingCurve::InCubic}, {"outcubic", QEasingCurve::OutCubic}, {"inoutcubic", QEasingCurve::InOutCubic},
-                                                           {"inquart", QEasingCurve::InQuart}, {"outquart", QEasingCurve::OutQuart}, {"inoutquart", QEasingCurve::InOutQuart},
-                                                           {"inquint", QEasingCurve::InQuint}, {"outquint", QEasingCurve::OutQuint}, {"inoutquint", QEasingCurve::InOutQuint},
-                                                           {"insine", QEasingCurve::InSine}, {"outsine", QEasingCurve::OutSine}, {"inoutsine", QEasingCurve::InOutSine},
-                                                           {"inexpo", QEasingCurve::InExpo}, {"outexpo", QEasingCurve::OutExpo}, {"inoutexpo", QEasingCurve::InOutExpo},
-                                                           {"inelastic", QEasingCurve::InElastic}, {"outelastic", QEasingCurve::OutElastic}, {"inoutelastic", QEasingCurve::InOutElastic},
-                                                           {"inback", QEasingCurve::InBack}, {"outback", QEasingCurve::OutBack}, {"inoutback", QEasingCurve::InOutBack},
-                                                           {"inbounce", QEasingCurve::InBounce}, {"outbounce", QEasingCurve::OutBounce}, {"inoutbounce", QEasingCurve::InOutBounce},
-                                                           };
-
-    return QEasingCurve(map.value(name, QEasingCurve::InOutQuad));
+    if (!v.isObject()) return QVariantMap();
+    return v.toVariant().toMap();
 }
 
 // Core animation builder used by both tween methods
 bool AbstractGameElement::buildAnimationsFromTo(const QVariantMap& from,
                                                 const QVariantMap& to,
                                                 int animTimeMs,
-                                                const QEasingCurve& easing,
+                                                QEasingCurve::Type easing,
                                                 QJSValue start_func,
                                                 QJSValue end_func)
 {
     if (m_propertyList.isEmpty()) return false;
 
-    // Stop previous group if any
-    if (m_animGroup) {
-        m_animGroup->stop();
-        m_animGroup->deleteLater();
-        m_animGroup = nullptr;
-    }
-    m_animGroup = new QParallelAnimationGroup(this);
-
     // Set 'from' values first (if provided)
+    QVector<GameTweenChannel> channels;
+    channels.reserve(m_propertyList.size());
     for (const auto& propName : m_propertyList) {
-        const QByteArray ba = propName.toUtf8();
-
         // Validate
-        if (!hasWritableProperty(this, ba)) {
+        const GamePropertyHandle handle = m_propertyCache.writable(this, propName);
+        if (!handle.isValid()) {
             qWarning() << "AbstractGameElement: property" << propName << "not found/writable on item";
             continue;
         }
 
+        GameTweenChannel channel;
+        channel.property = handle.property;
+
         // If 'from' has a value for this property, set it now
-        if (from.contains(propName)) {
-            this->setProperty(ba.constData(), from.value(propName));
-        } else if (!from.isEmpty()) {
-            // Scalar-start case is handled by caller via repeating keys, so we only act on present keys
-        }
+        if (from.contains(propName))
+            channel.property.write(this, from.value(propName));
+        // If no explicit 'to', animate back to current (which may have been captured)
+        channel.to = to.value(propName);
+        channels.append(channel);
+    }
+
+    return startTween(channels, animTimeMs, easing, start_func, end_func);
+}
+
+// Replaces the running tween with channels. A channel without a 'from'
+// value starts from wherever the start callback left its property; one
+// without a 'to' value ends there too.
+bool AbstractGameElement::startTween(QVector<GameTweenChannel>& channels, int animTimeMs,
+                                     QEasingCurve::Type easing, QJSValue start_func, QJSValue end_func)
+{
+    // Nothing to animate: leave both callbacks to the caller's fallback
+    if (channels.isEmpty()) return false;
+
+    // Stop previous tween if any
+    GameTweenEngine* engine = GameTweenEngine::instance();
+    if (m_tween) {
+        engine->cancel(m_tween);
+        m_tween = 0;
     }
 
     // Optional start callback
     if (start_func.isCallable()) {
         QJSValueList args;
-        args << qmlEngine(this)->newQObject(this);
+        args << jsWrapper();
         start_func.call(args);
     }
 
-    // Build animations to 'to' values
-    for (const auto& propName : m_propertyList) {
-        const QByteArray ba = propName.toUtf8();
-        if (!hasWritableProperty(this, ba)) continue;
-
-        auto* anim = new QPropertyAnimation(this, ba, m_animGroup);
-        anim->setDuration(animTimeMs);
-        anim->setEasingCurve(easing);
-
-        if (to.contains(propName)) {
-            anim->setEndValue(to.value(propName));
-        } else {
-            // If no explicit 'to', animate back to current (which may have been captured)
-            anim->setEndValue(this->property(ba.constData()));
-        }
-        m_animGroup->addAnimation(anim);
+    for (GameTweenChannel& channel : channels) {
+        if (!channel.from.isValid())
+            channel.from = channel.property.read(this);
+        if (!channel.to.isValid())
+            channel.to = channel.from;
     }
 
-    // End callback hookup
-    connect(m_animGroup, &QParallelAnimationGroup::finished, this, [this, end_func]() mutable {
+    QPointer<AbstractGameElement> that(this);
+    m_tween = engine->start(this, channels, animTimeMs, easing, [that, end_func]() mutable {
+        if (!that) return;
+        that->m_tween = 0;
         if (end_func.isCallable()) {
             QJSValueList args;
-            args << qmlEngine(this)->newQObject(this);
+            args << that->jsWrapper();
             end_func.call(args);
         }
-        emit tweenFinished();
-        // auto-cleanup
-        m_animGroup->deleteLater();
-        m_animGroup = nullptr;
+        emit that->tweenFinished();
     });
+    if (!m_tween) return false;
 
     emit tweenStarted();
-    m_animGroup->start(QAbstractAnimation::DeleteWhenStopped);
     return true;
 }
 
@@ -228,10 +191,12 @@ bool AbstractGameElement::tweenPropertiesFrom(QJSValue start, int animTimeMs, QJ
     }
 
     QVariantMap to;
-    for (const auto& p : m_propertyList)
-        to.insert(p, this->property(p.toUtf8().constData()));
+    for (const auto& p : m_propertyList) {
+        const GamePropertyHandle handle = m_propertyCache.writable(this, p);
+        to.insert(p, handle.isValid() ? handle.property.read(this) : QVariant());
+    }
 
-    return buildAnimationsFromTo(from, to, animTimeMs, easingFromQJSValue(easingVal), start_func, end_func);
+    return buildAnimationsFromTo(from, to, animTimeMs, GameEasing::fromJSValue(easingVal), start_func, end_func);
 }
 
 bool AbstractGameElement::tweenPropertiesTo(QJSValue end, int animTimeMs, QJSValue easingVal,
@@ -250,7 +215,95 @@ bool AbstractGameElement::tweenPropertiesTo(QJSValue end, int animTimeMs, QJSVal
     }
 
     QVariantMap from; // animate from current
-    return buildAnimationsFromTo(from, to, animTimeMs, easingFromQJSValue(easingVal), start_func, end_func);
+    return buildAnimationsFromTo(from, to, animTimeMs, GameEasing::fromJSValue(easingVal), start_func, end_func);
+}
+
+TweenSpec AbstractGameElement::tweenSpec(QJSValue fields) const
+{
+    TweenSpec spec;
+    if (!fields.isObject())
+        return spec;
+    for (int field = 0; field < TweenSpec::FieldCount; ++field) {
+        const QJSValue value = fields.property(TweenSpec::fieldName(TweenSpec::Field(field)));
+        if (value.isNumber())
+            spec.set(TweenSpec::Field(field), value.toNumber());
+    }
+    const QJSValue easing = fields.property(QStringLiteral("easing"));
+    spec.setEasing(easing.isUndefined() ? GameEasing::Default : GameEasing::fromJSValue(easing));
+    return spec;
+}
+
+bool AbstractGameElement::tweenTo(const TweenSpec& spec, int animTimeMs, QJSValue start_func, QJSValue end_func)
+{
+    if (spec.isEmpty()) return false;
+
+    QVector<GameTweenChannel> channels;
+    channels.reserve(TweenSpec::FieldCount);
+    for (int field = 0; field < TweenSpec::FieldCount; ++field) {
+        if (!spec.has(TweenSpec::Field(field)))
+            continue;
+        const GamePropertyHandle handle = m_propertyCache.writable(this, TweenSpec::fieldName(TweenSpec::Field(field)));
+        if (!handle.isValid())
+            continue;
+        GameTweenChannel channel;
+        channel.property = handle.property;
+        channel.to = spec.value(TweenSpec::Field(field));
+        channels.append(channel);
+    }
+    return startTween(channels, animTimeMs, spec.easingType(), start_func, end_func);
+}
+
+bool AbstractGameElement::tweenKeyframes(QJSValue keyframes, int totalMs, QJSValue start_func, QJSValue end_func)
+{
+    if (!keyframes.isArray()) return false;
+    const int count = keyframes.property(QStringLiteral("length")).toInt();
+    if (count <= 0) return false;
+    totalMs = qMax(0, totalMs);
+
+    QVector<GameTweenChannel> channels;
+    QHash<int, int> lastSegment; // property index -> its latest channel
+    int previousMs = 0;
+    for (int k = 0; k < count; ++k) {
+        const QJSValue frame = keyframes.property(quint32(k));
+        if (!frame.isObject()) continue;
+
+        const QJSValue at = frame.property(QStringLiteral("at"));
+        const qreal fraction = at.isNumber() ? at.toNumber() : qreal(k + 1) / count;
+        const int frameMs = qBound(previousMs, qRound(fraction * totalMs), totalMs);
+        const QJSValue easingVal = frame.property(QStringLiteral("easing"));
+        const QEasingCurve::Type easing = easingVal.isUndefined() ? GameEasing::Default
+                                                                  : GameEasing::fromJSValue(easingVal);
+
+        QJSValueIterator it(frame);
+        while (it.hasNext()) {
+            it.next();
+            const QString propName = it.name();
+            if (propName == QLatin1String("at") || propName == QLatin1String("easing"))
+                continue;
+            const GamePropertyHandle handle = m_propertyCache.writable(this, propName);
+            if (!handle.isValid()) {
+                qWarning() << "AbstractGameElement: property" << propName << "not found/writable on item";
+                continue;
+            }
+
+            GameTweenChannel channel;
+            channel.property = handle.property;
+            channel.to = it.value().toVariant();
+            channel.easing = easing;
+            // Continue from this property's previous keyframe, if it had one
+            const int previous = lastSegment.value(handle.property.propertyIndex(), -1);
+            if (previous >= 0) {
+                channel.from = channels.at(previous).to;
+                channel.delayMs = channels.at(previous).delayMs + channels.at(previous).durationMs;
+            }
+            channel.durationMs = frameMs - channel.delayMs;
+            lastSegment.insert(handle.property.propertyIndex(), channels.size());
+            channels.append(channel);
+        }
+        previousMs = frameMs;
+    }
+
+    return startTween(channels, totalMs, QEasingCurve::Linear, start_func, end_func);
 }
 
 
@@ -390,12 +443,13 @@ void AbstractGameElement::beginProcessExecutionQueueTimed(int intervalMs)
         return;
     }
     setExecutionQueuePaused(false);
+    m_executionIntervalMs = qMax(0, intervalMs);
     emit executionQueueStarted();
-    // kick off immediately (first item), then schedule the next with delay
-    processNextQueueItemTimed(intervalMs);
+    // First job on the next frame, the rest one interval apart
+    GameFrameScheduler::instance()->schedule(this, 0);
 }
 
-void AbstractGameElement::processNextQueueItemTimed(int intervalMs)
+void AbstractGameElement::runNextExecutionQueueJob()
 {
     if (m_executionQueuePaused) return;
     if (m_executionQueue.isEmpty()) {
@@ -404,32 +458,28 @@ void AbstractGameElement::processNextQueueItemTimed(int intervalMs)
     }
 
     // Pop-front and execute
-    QJSValue func = m_executionQueue.front();
-    m_executionQueue.pop_front();
+    const QJSValue func = m_executionQueue.takeFirst();
+    QPointer<AbstractGameElement> that(this);
     if (func.isCallable()) {
         QJSValueList args;
-        args << qmlEngine(this)->newQObject(this);
+        args << jsWrapper();
         func.call(args);
     }
+    if (!that) return;
 
-    if (m_executionQueuePaused) return;
+    // The job may have paused, cleared or restarted the queue
+    if (m_executionQueuePaused || GameFrameScheduler::instance()->isScheduled(this)) return;
     if (m_executionQueue.isEmpty()) {
         emit executionQueueEmpty();
         return;
     }
-
-    // Chain the next execution after the interval (single-shot each step)
-    QPointer<AbstractGameElement> that(this);
-    QTimer::singleShot(intervalMs, this, [that, intervalMs]() {
-        if (!that) return;
-        if (that->m_executionQueuePaused) return;
-        that->processNextQueueItemTimed(intervalMs);
-    });
+    GameFrameScheduler::instance()->schedule(this, m_executionIntervalMs);
 }
 
 void AbstractGameElement::pauseProcessExecutionQueueTimed()
 {
     setExecutionQueuePaused(true);
+    GameFrameScheduler::instance()->unschedule(this);
 }
 
 void AbstractGameElement::beginProcessExecutionQueueAsync()
@@ -439,24 +489,17 @@ void AbstractGameElement::beginProcessExecutionQueueAsync()
         return;
     }
 
+    setExecutionQueuePaused(false);
+    m_executionIntervalMs = 0;
     emit executionQueueStarted();
-    // Copy then clear to ensure reentrancy safety
-    const auto copy = m_executionQueue;
-    m_executionQueue.clear();
-
-    for (const auto& func : copy) {
-        if (func.isCallable()) {
-            QJSValueList args;
-            args << qmlEngine(this)->newQObject(this);
-            func.call(args);
-        }
-    }
-    emit executionQueueEmpty();
+    // Back to back, as many per frame as the scheduler's budget allows
+    GameFrameScheduler::instance()->schedule(this, 0);
 }
 
 void AbstractGameElement::clearExecutionQueue()
 {
     m_executionQueue.clear();
+    GameFrameScheduler::instance()->unschedule(this);
 }
 
 QVariantMap AbstractGameElement::serialize() const
@@ -468,10 +511,10 @@ QVariantMap AbstractGameElement::serialize() const
 
     QVariantMap properties;
     for (const QString& propName : m_propertyList) {
-        const QByteArray propKey = propName.toUtf8();
-        if (!hasWritableProperty(const_cast<AbstractGameElement*>(this), propKey))
+        const GamePropertyHandle handle = m_propertyCache.writable(this, propName);
+        if (!handle.isValid())
             continue;
-        const QVariant value = this->property(propKey.constData());
+        const QVariant value = handle.property.read(this);
         if (value.isValid())
             properties.insert(propName, value);
     }
@@ -491,10 +534,10 @@ bool AbstractGameElement::unserialize(const QVariantMap& data)
 
     const QVariantMap properties = data.value(QStringLiteral("properties")).toMap();
     for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
-        const QByteArray propKey = it.key().toUtf8();
-        if (!hasWritableProperty(this, propKey))
+        const GamePropertyHandle handle = m_propertyCache.writable(this, it.key());
+        if (!handle.isValid())
             continue;
-        setProperty(propKey.constData(), it.value());
+        handle.property.write(this, it.value());
     }
 
     return true;
@@ -8,11 +8,14 @@
 #include <QTimer>
 #include <QStringList>
 
+#include "gamepropertycache.h"
+#include "gametweenspec.h"
+
 /* #include <QtQml/qqmlregistration.h> */
 
+struct GameTweenChannel;
 
 
-class QParallelAnimationGroup;
 
 class AbstractGameElement : public QQuickItem
 {
@@ -21,6 +24,7 @@ class AbstractGameElement : public QQuickItem
     Q_PROPERTY(QStringList propertyList READ propertyList WRITE setPropertyList NOTIFY propertyListChanged)
     Q_PROPERTY(QObject* loader READ loader WRITE setLoader NOTIFY loaderChanged)
     Q_PROPERTY(bool executionQueuePaused READ executionQueuePaused WRITE setExecutionQueuePaused NOTIFY executionQueuePausedChanged)
+    Q_PROPERTY(int executionQueuePriority READ executionQueuePriority WRITE setExecutionQueuePriority NOTIFY executionQueuePriorityChanged)
 
 public:
     explicit AbstractGameElement(QQuickItem* parent = nullptr);
@@ -38,6 +42,11 @@ public:
     bool executionQueuePaused() const { return m_executionQueuePaused; }
     void setExecutionQueuePaused(bool paused);
 
+    // Higher runs first when GameFrameScheduler has more due jobs than
+    // fit in a frame
+    int executionQueuePriority() const { return m_executionQueuePriority; }
+    void setExecutionQueuePriority(int priority);
+
     // Tweens
     Q_INVOKABLE bool tweenPropertiesFrom(QJSValue start, int animTimeMs, QJSValue easing,
                                          QJSValue start_func = QJSValue(), QJSValue end_func = QJSValue());
@@ -45,6 +54,21 @@ public:
     Q_INVOKABLE bool tweenPropertiesTo(QJSValue end, int animTimeMs, QJSValue easing,
                                        QJSValue start_func = QJSValue(), QJSValue end_func = QJSValue());
 
+    // Typed tweens: build a spec once, then tween to copies of it. Only the
+    // spec's own fields are animated; propertyList is left alone.
+    Q_INVOKABLE TweenSpec tweenSpec(QJSValue fields = QJSValue()) const;
+    Q_INVOKABLE bool tweenTo(const TweenSpec& spec, int animTimeMs,
+                             QJSValue start_func = QJSValue(), QJSValue end_func = QJSValue());
+
+    // Keyframes: an array of { <property>: value, ..., at, easing } objects.
+    // 'at' is the fraction of totalMs where the keyframe is reached (spread
+    // evenly when left out) and 'easing' shapes the segment leading up to
+    // it. A property runs from its previous keyframe, or from where it is
+    // once start_func has run; an 'at: 0' keyframe sets starting values.
+    // The whole path is one tween with one end callback.
+    Q_INVOKABLE bool tweenKeyframes(QJSValue keyframes, int totalMs,
+                                    QJSValue start_func = QJSValue(), QJSValue end_func = QJSValue());
+
     // Particles
     Q_INVOKABLE bool attachParticleSystem(QObject* particleSystem);
     Q_INVOKABLE bool detachParticleSystem(QJSValue which = QJSValue()); // undefined/null => all
@@ -59,7 +83,9 @@ public:
     Q_INVOKABLE QVariantMap getGlobalPos() const; // { x, y, z }
     Q_INVOKABLE bool setGlobalPos(qreal x, qreal y, qreal z);
 
-    // Execution queue (for "then" chaining)
+    // Execution queue (for "then" chaining). Jobs run on GameFrameScheduler
+    // frames: timed processing runs one job per interval, async processing
+    // runs them back to back within each frame's budget.
     Q_INVOKABLE QVariantList getExecutionQueue() const; // returns list of QJSValue (functions)
     Q_INVOKABLE bool addFunctionToExecutionQueue(QJSValue func_to_execute);
     Q_INVOKABLE void beginProcessExecutionQueueTimed(int intervalMs);
@@ -74,6 +100,7 @@ signals:
     void propertyListChanged();
     void loaderChanged();
     void executionQueuePausedChanged();
+    void executionQueuePriorityChanged();
 
     // Optional niceties:
     void tweenStarted();
@@ -84,32 +111,43 @@ signals:
 protected:
     void componentComplete() override;
 
+    // The JS object for this element, created once and passed to callbacks
+    QJSValue jsWrapper();
+
 private:
+    friend class GameFrameScheduler;
+
     // helpers
     static bool isScalar(const QJSValue& v);
     static QVariant toVariant(const QJSValue& v);
     static QVariantMap toVariantMap(const QJSValue& v);
-    QEasingCurve easingFromQJSValue(const QJSValue& easing) const;
-    bool hasWritableProperty(QObject* obj, const QByteArray& name, QVariant::Type* typeOut = nullptr) const;
 
     bool buildAnimationsFromTo(const QVariantMap& from, const QVariantMap& to,
-                               int animTimeMs, const QEasingCurve& easing,
+                               int animTimeMs, QEasingCurve::Type easing,
                                QJSValue start_func, QJSValue end_func);
+    bool startTween(QVector<GameTweenChannel>& channels, int animTimeMs, QEasingCurve::Type easing,
+                    QJSValue start_func, QJSValue end_func);
 
-    void processNextQueueItemTimed(int intervalMs);
+    void runNextExecutionQueueJob();
 
 private:
     QStringList m_propertyList;
+    // resolved handles for m_propertyList, tweens and unserialize()
+    mutable GamePropertyCache m_propertyCache;
     QObject* m_loader = nullptr;
 
     QList<QObject*> m_particleSystems;
 
-    // animation
-    QParallelAnimationGroup* m_animGroup = nullptr;
+    // running GameTweenEngine tween, 0 when idle
+    int m_tween = 0;
 
     // execution queue
     QList<QJSValue> m_executionQueue;
     bool m_executionQueuePaused = false;
+    int m_executionQueuePriority = 0;
+    int m_executionIntervalMs = 0;
+
+    QJSValue m_jsWrapper;
 };
 
 #endif // ABSTRACTGAMEELEMENT_H
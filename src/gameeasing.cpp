@@ -0,0 +1,53 @@
+#include "gameeasing.h"
+
+#include <QHash>
+
+namespace {
+const QHash<QString, QEasingCurve::Type>& easingNames()
+{
+    static const QHash<QString, QEasingCurve::Type> names = {
+        {"linear", QEasingCurve::Linear},
+        {"inquad", QEasingCurve::InQuad}, {"outquad", QEasingCurve::OutQuad}, {"inoutquad", QEasingCurve::InOutQuad},
+        {"incubic", QEasingCurve::InCubic}, {"outcubic", QEasingCurve::OutCubic}, {"inoutcubic", QEasingCurve::InOutCubic},
+        {"inquart", QEasingCurve::InQuart}, {"outquart", QEasingCurve::OutQuart}, {"inoutquart", QEasingCurve::InOutQuart},
+        {"inquint", QEasingCurve::InQuint}, {"outquint", QEasingCurve::OutQuint}, {"inoutquint", QEasingCurve::InOutQuint},
+        {"insine", QEasingCurve::InSine}, {"outsine", QEasingCurve::OutSine}, {"inoutsine", QEasingCurve::InOutSine},
+        {"inexpo", QEasingCurve::InExpo}, {"outexpo", QEasingCurve::OutExpo}, {"inoutexpo", QEasingCurve::InOutExpo},
+        {"inelastic", QEasingCurve::InElastic}, {"outelastic", QEasingCurve::OutElastic}, {"inoutelastic", QEasingCurve::InOutElastic},
+        {"inback", QEasingCurve::InBack}, {"outback", QEasingCurve::OutBack}, {"inoutback", QEasingCurve::InOutBack},
+        {"inbounce", QEasingCurve::InBounce}, {"outbounce", QEasingCurve::OutBounce}, {"inoutbounce", QEasingCurve::InOutBounce},
+    };
+    return names;
+}
+}
+
+QEasingCurve::Type GameEasing::fromJSValue(const QJSValue& value)
+{
+    if (value.isNumber()) {
+        const int type = value.toInt();
+        if (type < 0 || type >= QEasingCurve::NCurveTypes)
+            return Default;
+        return static_cast<QEasingCurve::Type>(type);
+    }
+
+    if (value.isObject()) {
+        const QJSValue easing = value.property(QStringLiteral("easing"));
+        if (!easing.isUndefined())
+            return fromJSValue(easing);
+        const QJSValue type = value.property(QStringLiteral("type"));
+        if (!type.isUndefined())
+            return fromJSValue(type);
+    }
+
+    if (!value.isString())
+        return Default;
+    return fromName(value.toString());
+}
+
+QEasingCurve::Type GameEasing::fromName(QStringView name)
+{
+    name = name.trimmed();
+    if (name.startsWith(u"Easing.", Qt::CaseInsensitive))
+        name = name.mid(7);
+    return easingNames().value(name.toString().toLower(), Default);
+}
@@ -0,0 +1,23 @@
+#ifndef GAMEEASING_H
+#define GAMEEASING_H
+
+#include <QEasingCurve>
+#include <QJSValue>
+#include <QStringView>
+
+// The one easing-name table shared by every game element. Resolve a QML
+// easing argument once and keep the enum; QML's Easing.* values are plain
+// numbers and skip the table altogether.
+class GameEasing
+{
+public:
+    static constexpr QEasingCurve::Type Default = QEasingCurve::InOutQuad;
+
+    // Accepts a QEasingCurve::Type number, { easing: ... } or { type: ... },
+    // or a name such as "linear", "InOutQuad" or "Easing.OutCubic".
+    static QEasingCurve::Type fromJSValue(const QJSValue& value);
+    // Case-insensitive, with or without an "Easing." prefix; Default when unknown.
+    static QEasingCurve::Type fromName(QStringView name);
+};
+
+#endif // GAMEEASING_H
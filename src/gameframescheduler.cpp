@@ -0,0 +1,196 @@
+#include "gameframescheduler.h"
+#include "abstractgameelement.h"
+
+#include <QCoreApplication>
+#include <QQuickWindow>
+
+#include <limits>
+
+namespace {
+static const double kDefaultFrameBudgetMs = 4.0;
+// Frame interval used for elements that are not shown in a window.
+static const int kFallbackFrameMs = 16;
+// A requested frame that has not arrived by then is not coming, e.g. the
+// window was minimized in between; the jobs run from the timer instead.
+static const int kFrameTimeoutMs = 100;
+}
+
+GameFrameScheduler::GameFrameScheduler(QObject* parent)
+    : QObject(parent)
+    , m_frameBudgetMs(kDefaultFrameBudgetMs)
+{
+    m_clock.start();
+    m_wakeTimer.setSingleShot(true);
+    connect(&m_wakeTimer, &QTimer::timeout, this, &GameFrameScheduler::wake);
+}
+
+GameFrameScheduler* GameFrameScheduler::instance()
+{
+    static QPointer<GameFrameScheduler> scheduler;
+    if (!scheduler)
+        scheduler = new GameFrameScheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+void GameFrameScheduler::setFrameBudgetMs(double budgetMs)
+{
+    m_frameBudgetMs = qMax(0.0, budgetMs);
+}
+
+void GameFrameScheduler::schedule(AbstractGameElement* element, int delayMs)
+{
+    if (!element)
+        return;
+    if (QQuickWindow* window = element->window())
+        attachWindow(window);
+
+    Entry entry;
+    entry.element = element;
+    entry.dueMs = m_clock.elapsed() + qMax(0, delayMs);
+    entry.order = m_nextOrder++;
+    const int index = indexOf(element);
+    if (index >= 0)
+        m_entries[index] = entry;
+    else
+        m_entries.append(entry);
+
+    // runFrame() arms once it is done with the current frame.
+    if (!m_running)
+        arm(0);
+}
+
+void GameFrameScheduler::unschedule(AbstractGameElement* element)
+{
+    const int index = indexOf(element);
+    if (index >= 0)
+        m_entries.removeAt(index);
+    if (m_entries.isEmpty())
+        m_wakeTimer.stop();
+}
+
+bool GameFrameScheduler::isScheduled(const AbstractGameElement* element) const
+{
+    return indexOf(element) >= 0;
+}
+
+int GameFrameScheduler::indexOf(const AbstractGameElement* element) const
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).element == element)
+            return i;
+    }
+    return -1;
+}
+
+void GameFrameScheduler::attachWindow(QQuickWindow* window)
+{
+    for (const QPointer<QQuickWindow>& known : std::as_const(m_windows)) {
+        if (known == window)
+            return;
+    }
+    m_windows.append(window);
+    connect(window, &QQuickWindow::afterAnimating, this, &GameFrameScheduler::runFrame);
+}
+
+bool GameFrameScheduler::hasExposedWindow()
+{
+    m_windows.removeAll(QPointer<QQuickWindow>());
+    for (const QPointer<QQuickWindow>& window : std::as_const(m_windows)) {
+        if (window->isExposed())
+            return true;
+    }
+    return false;
+}
+
+void GameFrameScheduler::runFrame()
+{
+    m_frameRequested = false;
+    if (m_running || m_entries.isEmpty())
+        return;
+    m_running = true;
+
+    QElapsedTimer frame;
+    frame.start();
+    const qint64 budgetNs = qint64(m_frameBudgetMs * 1.0e6);
+    do {
+        const qint64 now = m_clock.elapsed();
+        int next = -1;
+        for (int i = 0; i < m_entries.size(); ++i) {
+            const Entry& entry = m_entries.at(i);
+            if (!entry.element || entry.dueMs > now)
+                continue;
+            if (next < 0) {
+                next = i;
+                continue;
+            }
+            const Entry& best = m_entries.at(next);
+            const int priority = entry.element->executionQueuePriority();
+            const int bestPriority = best.element->executionQueuePriority();
+            if (priority != bestPriority ? priority > bestPriority
+                                         : (entry.dueMs != best.dueMs ? entry.dueMs < best.dueMs
+                                                                      : entry.order < best.order)) {
+                next = i;
+            }
+        }
+        if (next < 0)
+            break;
+
+        // The job may schedule the element again, or schedule others.
+        const QPointer<AbstractGameElement> element = m_entries.at(next).element;
+        m_entries.removeAt(next);
+        element->runNextExecutionQueueJob();
+    } while (frame.nsecsElapsed() < budgetNs);
+
+    for (int i = m_entries.size() - 1; i >= 0; --i) {
+        if (!m_entries.at(i).element)
+            m_entries.removeAt(i);
+    }
+    m_running = false;
+
+    // Work left for now waits a frame; without a shown window, one timer
+    // interval.
+    arm(hasExposedWindow() ? 0 : kFallbackFrameMs);
+}
+
+void GameFrameScheduler::wake()
+{
+    // Hidden and minimized windows render no frames, so nothing would
+    // emit afterAnimating for them.
+    if (m_frameRequested || !hasExposedWindow()) {
+        m_frameRequested = false;
+        runFrame();
+        return;
+    }
+    m_frameRequested = true;
+    for (const QPointer<QQuickWindow>& window : std::as_const(m_windows)) {
+        if (window->isExposed())
+            window->update();
+    }
+    m_wakeTimer.start(kFrameTimeoutMs);
+}
+
+void GameFrameScheduler::arm(int minimumDelayMs)
+{
+    if (m_entries.isEmpty()) {
+        m_wakeTimer.stop();
+        return;
+    }
+
+    qint64 earliest = std::numeric_limits<qint64>::max();
+    for (const Entry& entry : std::as_const(m_entries))
+        earliest = qMin(earliest, entry.dueMs);
+    const int delayMs = int(qBound<qint64>(minimumDelayMs, earliest - m_clock.elapsed(),
+                                           std::numeric_limits<int>::max()));
+
+    if (delayMs == 0 && hasExposedWindow()) {
+        // The next frame's afterAnimating runs it; the timer wake() starts
+        // covers for a frame that never comes.
+        if (!m_frameRequested)
+            wake();
+        else if (!m_wakeTimer.isActive())
+            m_wakeTimer.start(kFrameTimeoutMs);
+        return;
+    }
+    if (!m_wakeTimer.isActive() || m_wakeTimer.remainingTime() > delayMs)
+        m_wakeTimer.start(delayMs);
+}
@@ -0,0 +1,68 @@
+#ifndef GAMEFRAMESCHEDULER_H
+#define GAMEFRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+class AbstractGameElement;
+class QQuickWindow;
+
+// Scene-wide runner for element execution queues. Each scheduled element
+// has one pending job; on every frame of the element's window (afterAnimating)
+// due jobs run highest executionQueuePriority first, equal priorities in the
+// order they became due, until the frame budget is spent. What is left
+// waits for the next frame, so a burst of queued work is spread over frames
+// instead of stalling one. Elements outside a window, or whose windows are
+// hidden or minimized, are run from a timer at about the same rate. Lives
+// on the GUI thread.
+class GameFrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static GameFrameScheduler* instance();
+
+    // Time spent on jobs per frame. The first due job of a frame always
+    // runs, and a job that starts inside the budget runs to completion.
+    double frameBudgetMs() const { return m_frameBudgetMs; }
+    void setFrameBudgetMs(double budgetMs);
+
+    // Runs element's next queued job no sooner than delayMs from now,
+    // replacing the job it already had scheduled.
+    void schedule(AbstractGameElement* element, int delayMs);
+    void unschedule(AbstractGameElement* element);
+    bool isScheduled(const AbstractGameElement* element) const;
+    int scheduledCount() const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        QPointer<AbstractGameElement> element;
+        qint64 dueMs = 0;
+        quint64 order = 0;
+    };
+
+    explicit GameFrameScheduler(QObject* parent = nullptr);
+
+    void attachWindow(QQuickWindow* window);
+    bool hasExposedWindow();
+    void runFrame();
+    void wake();
+    // Asks for the frame, or sets the timer, that runs the next due job.
+    void arm(int minimumDelayMs);
+    int indexOf(const AbstractGameElement* element) const;
+
+    QVector<Entry> m_entries;
+    QVector<QPointer<QQuickWindow>> m_windows;
+    QElapsedTimer m_clock;
+    QTimer m_wakeTimer;
+    double m_frameBudgetMs;
+    quint64 m_nextOrder = 0;
+    bool m_running = false;
+    bool m_frameRequested = false;
+};
+
+#endif // GAMEFRAMESCHEDULER_H
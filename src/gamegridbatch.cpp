@@ -0,0 +1,50 @@
+#include "gamegridbatch.h"
+#include "gamegridorchestrator.h"
+#include "gridparallel.h"
+#include "gridsimulation.h"
+
+GameGridBatch::GameGridBatch(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QVariantList GameGridBatch::resolveCascades(const QVariantList &grids)
+{
+    QList<GameGridOrchestrator *> orchestrators;
+    orchestrators.reserve(grids.size());
+    for (const QVariant &grid : grids)
+        orchestrators.append(qobject_cast<GameGridOrchestrator *>(grid.value<QObject *>()));
+
+    QList<QList<GridCascadeEvent>> timelines;
+    resolveCascades(orchestrators, timelines);
+
+    QVariantList results;
+    results.reserve(timelines.size());
+    for (const QList<GridCascadeEvent> &timeline : std::as_const(timelines))
+        results.append(QVariant::fromValue(GameGridOrchestrator::packTimeline(timeline)));
+    return results;
+}
+
+void GameGridBatch::resolveCascades(const QList<GameGridOrchestrator *> &grids,
+                                    QList<QList<GridCascadeEvent>> &timelines)
+{
+    const int count = grids.size();
+    QVector<GridSimulation> simulations(count);
+    QVector<int> active;
+    timelines.clear();
+    timelines.resize(count);
+    for (int i = 0; i < count; ++i) {
+        if (grids.at(i) && grids.at(i)->beginCascade(simulations[i]))
+            active.append(i);
+    }
+
+    // One band per grid. Large boards band their own work inside settle(),
+    // which GridParallel allows from a helper thread.
+    GridParallel::run(active.size(), [&simulations, &active, &timelines](int band) {
+        const int grid = active.at(band);
+        simulations[grid].settle(&timelines[grid]);
+    });
+
+    for (const int grid : std::as_const(active))
+        grids.at(grid)->commitCascade(simulations.at(grid), timelines.at(grid));
+}
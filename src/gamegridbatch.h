@@ -0,0 +1,33 @@
+#ifndef GAMEGRIDBATCH_H
+#define GAMEGRIDBATCH_H
+
+#include "gridinstructions.h"
+#include <QList>
+#include <QObject>
+#include <QVariantList>
+
+class GameGridOrchestrator;
+
+// Resolves the cascades of several grids in one call, such as the player
+// and CPU boards of a match. Each grid's board is copied on the calling
+// thread, all of them settle in parallel on GridParallel, and the results
+// are committed back in list order on the calling thread, so every grid
+// emits exactly what its own resolveCascade() would have.
+class GameGridBatch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GameGridBatch(QObject *parent = nullptr);
+
+    // grids holds GameGridOrchestrator objects; anything else yields an
+    // empty timeline. Returns one packed resolveCascade() timeline per
+    // entry, in the same order.
+    Q_INVOKABLE QVariantList resolveCascades(const QVariantList &grids);
+
+    // Typed form; timelines receives one entry per grid.
+    static void resolveCascades(const QList<GameGridOrchestrator *> &grids,
+                                QList<QList<GridCascadeEvent>> &timelines);
+};
+
+#endif // GAMEGRIDBATCH_H
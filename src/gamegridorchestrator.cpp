@@ -1,12 +1,47 @@
 #include "gamegridorchestrator.h"
-#include <QSet>
+#include "gridcpupolicy.h"
+#include <QDebug>
+#include <QThreadPool>
 #include <algorithm>
 
 namespace {
-static const quint32 kLcgMultiplier = 1664525u;
-static const quint32 kLcgIncrement = 1013904223u;
-static const quint32 kLcgModulus = 0xFFFFFFFFu;
 static const int kDefaultHp = 10;
+static const int kTripletStride = 3;
+static const int kRecordStride = 5;
+static const int kShapeStride = 8;
+// Quantization of relative spawn weights; the heaviest color gets this.
+static const int kWeightResolution = 4096;
+// Largest board side accepted, the top of the large-board range.
+static const int kMaxBoardSide = 1024;
+// Redraws reshuffle() allows when a small palette forces a match.
+static const int kMaxReshuffleAttempts = 8;
+
+QVariantList movesToVariant(const QList<GridMove> &moves)
+{
+    QVariantList list;
+    list.reserve(moves.size());
+    for (const GridMove &move : moves) {
+        QVariantMap map;
+        map.insert(QStringLiteral("fromRow"), move.fromRow);
+        map.insert(QStringLiteral("toRow"), move.toRow);
+        map.insert(QStringLiteral("column"), move.column);
+        list.append(map);
+    }
+    return list;
+}
+
+QVariantList matchesToVariant(const QList<GridMatch> &matches)
+{
+    QVariantList list;
+    list.reserve(matches.size());
+    for (const GridMatch &match : matches) {
+        QVariantMap map;
+        map.insert(QStringLiteral("row"), match.row);
+        map.insert(QStringLiteral("column"), match.column);
+        list.append(map);
+    }
+    return list;
+}
 }
 
 GameGridOrchestrator::GameGridOrchestrator(QQuickItem *parent)
@@ -18,24 +53,44 @@ GameGridOrchestrator::GameGridOrchestrator(QQuickItem *parent)
         { QStringLiteral("blue"), QStringLiteral("#3b82f6") },
         { QStringLiteral("yellow"), QStringLiteral("#facc15") }
     };
-    rebuildPool();
+    for (const ColorEntry &entry : std::as_const(m_palette))
+        m_paletteKeys.append(entry.key);
+    m_board = GridBoard(m_rowCount, m_columnCount, m_paletteKeys);
+    m_matchTracker.reset(m_board);
+    m_moveIndex.reset(m_board);
+    m_spawnStream = GridSpawnStream(m_seed, m_palette.size(), m_columnCount);
+}
+
+GameGridOrchestrator::~GameGridOrchestrator()
+{
+    // Workers post their result back to this object, abandoned searches
+    // included; let every one of them drain first.
+    for (const QSharedPointer<GridTurnSearch> &search : std::as_const(m_searches))
+        search->cancel();
+    for (const QSharedPointer<GridTurnSearch> &search : std::as_const(m_searches))
+        search->waitForDone();
 }
 
 void GameGridOrchestrator::setRowCount(int value)
 {
-    if (m_rowCount == value || value <= 0)
+    if (m_rowCount == value || value <= 0 || value > kMaxBoardSide)
         return;
     m_rowCount = value;
-    rebuildPool();
+    cancelPlanning();
+    m_spawnStream.rewind();
+    resetBoard();
     emit rowCountChanged();
 }
 
 void GameGridOrchestrator::setColumnCount(int value)
 {
-    if (m_columnCount == value || value <= 0)
+    if (m_columnCount == value || value <= 0 || value > kMaxBoardSide)
         return;
     m_columnCount = value;
-    rebuildPool();
+    cancelPlanning();
+    m_spawnStream.setColumnCount(value);
+    m_spawnStream.rewind();
+    resetBoard();
     emit columnCountChanged();
 }
 
@@ -55,303 +110,933 @@ void GameGridOrchestrator::setSpawnSeed(quint32 value)
     if (m_seed == value)
         return;
     m_seed = value;
-    rebuildPool();
+    m_spawnStream.setSeed(value);
+    record(GridReplayEvent::Seed, { value });
     emit spawnSeedChanged();
 }
 
+QString GameGridOrchestrator::boardHashText() const
+{
+    return QStringLiteral("%1").arg(m_board.hash(), 16, 16, QLatin1Char('0'));
+}
+
+QVariantList GameGridOrchestrator::spawnPalette() const
+{
+    QVariantList entries;
+    entries.reserve(m_palette.size());
+    for (const ColorEntry &entry : m_palette) {
+        QVariantMap map;
+        map.insert(QStringLiteral("key"), entry.key);
+        map.insert(QStringLiteral("hex"), entry.hex);
+        map.insert(QStringLiteral("weight"), entry.weight);
+        entries.append(map);
+    }
+    return entries;
+}
+
+void GameGridOrchestrator::setSpawnPalette(const QVariantList &entries)
+{
+    QVector<ColorEntry> palette;
+    QStringList keys;
+    for (const QVariant &value : entries) {
+        const QVariantMap map = value.toMap();
+        ColorEntry entry;
+        entry.key = map.value(QStringLiteral("key")).toString();
+        entry.hex = map.value(QStringLiteral("hex")).toString();
+        entry.weight = map.value(QStringLiteral("weight"), 1.0).toReal();
+        if (entry.key.isEmpty() || keys.contains(entry.key)) {
+            qWarning() << "GameGridOrchestrator: skipping palette entry" << map;
+            continue;
+        }
+        if (palette.size() == GridSpawnStream::MaxColors) {
+            qWarning() << "GameGridOrchestrator: palette capped at" << GridSpawnStream::MaxColors << "colors";
+            break;
+        }
+        if (!(entry.weight > 0.0))
+            entry.weight = 0.0;
+        palette.append(entry);
+        keys.append(entry.key);
+    }
+    if (palette.isEmpty()) {
+        qWarning() << "GameGridOrchestrator: ignoring empty palette";
+        return;
+    }
+
+    const bool keysChanged = keys != m_paletteKeys;
+    m_palette = palette;
+    m_paletteKeys = keys;
+    applySpawnWeights();
+    if (keysChanged) {
+        cancelPlanning();
+        m_spawnStream.rewind();
+        resetBoard();
+    }
+    emit paletteChanged();
+}
+
+void GameGridOrchestrator::applySpawnWeights()
+{
+    qreal heaviest = 0.0;
+    for (const ColorEntry &entry : std::as_const(m_palette))
+        heaviest = qMax(heaviest, entry.weight);
+
+    // Without any positive weight every color spawns equally.
+    QVector<quint32> weights;
+    weights.reserve(m_palette.size());
+    for (const ColorEntry &entry : std::as_const(m_palette)) {
+        if (heaviest <= 0.0)
+            weights.append(1u);
+        else if (entry.weight <= 0.0)
+            weights.append(0u);
+        else
+            weights.append(quint32(qMax(1, qRound(entry.weight / heaviest * kWeightResolution))));
+    }
+    m_spawnStream.setWeights(weights);
+}
+
+void GameGridOrchestrator::setLargeBoard(bool value)
+{
+    if (m_largeBoard == value)
+        return;
+    m_largeBoard = value;
+    emit largeBoardChanged();
+}
+
+void GameGridOrchestrator::setVerifyMatches(bool value)
+{
+    if (m_verifyMatches == value)
+        return;
+    m_verifyMatches = value;
+    emit verifyMatchesChanged();
+}
+
 QVariantList GameGridOrchestrator::prepareFill(const QVariantList &matrixVariant)
 {
-    auto matrix = toMatrix(matrixVariant);
-    return prepareFillInternal(matrix);
+    GridBoard board = toBoard(matrixVariant);
+    QList<GridSpawn> spawns;
+    prepareFillInternal(board, spawns);
+    if (!spawns.isEmpty())
+        recordState(GridReplayEvent::Positions);
+
+    QVariantList instructions;
+    instructions.reserve(spawns.size());
+    for (const GridSpawn &spawn : std::as_const(spawns)) {
+        QVariantMap op;
+        op.insert(QStringLiteral("column"), spawn.column);
+        op.insert(QStringLiteral("targetRow"), spawn.targetRow);
+        op.insert(QStringLiteral("spawnRow"), spawn.spawnRow);
+        op.insert(QStringLiteral("spec"), spawnSpec(static_cast<quint8>(spawn.color)));
+        instructions.append(op);
+    }
+    return instructions;
 }
 
 QVariantList GameGridOrchestrator::compactionMoves(const QVariantList &matrixVariant)
 {
-    auto matrix = toMatrix(matrixVariant);
-    return compactionMovesInternal(matrix);
+    GridBoard board = toBoard(matrixVariant);
+    QList<GridMove> moves;
+    GridSimulation::compact(board, m_fillDirection, moves);
+    return movesToVariant(moves);
 }
 
 QVariantList GameGridOrchestrator::detectMatches(const QVariantList &matrixVariant) const
 {
-    const auto matrix = toMatrix(matrixVariant);
-    return detectMatchesInternal(matrix);
+    const GridBoard board = toBoard(matrixVariant);
+    QList<GridMatch> matches;
+    detectMatchesInternal(board, matches);
+    return matchesToVariant(matches);
 }
 
 QVariantMap GameGridOrchestrator::spawnSpecFor(const QVariantList &matrixVariant, int row, int column)
 {
-    auto matrix = toMatrix(matrixVariant);
-    const ColorEntry entry = chooseFromPool(matrix, row, column);
+    const GridBoard board = toBoard(matrixVariant);
+    if (!board.contains(row, column))
+        return spawnSpec(GridBoard::EmptyCell);
+    const quint8 color = chooseSpawn(board, row, column);
+    recordState(GridReplayEvent::Positions);
+    return spawnSpec(color);
+}
 
-    QVariantMap spec;
-    spec.insert(QStringLiteral("colorKey"), entry.key);
-    spec.insert(QStringLiteral("colorHex"), entry.hex);
-    spec.insert(QStringLiteral("hp"), kDefaultHp);
-    return spec;
+GridBoard GameGridOrchestrator::makeBoard(const QVariantList &matrixVariant) const
+{
+    return toBoard(matrixVariant);
 }
 
-void GameGridOrchestrator::resetPool()
+QStringList GameGridOrchestrator::paletteColors() const
 {
-    rebuildPool();
+    QStringList colors;
+    colors.reserve(m_palette.size());
+    for (const ColorEntry &entry : m_palette)
+        colors.append(entry.hex);
+    return colors;
 }
 
-void GameGridOrchestrator::rebuildPool()
+int GameGridOrchestrator::spawnHp() const
 {
-    m_spawnPool.clear();
-    m_poolIndex = 0;
-    if (m_palette.isEmpty())
-        return;
+    return kDefaultHp;
+}
+
+void GameGridOrchestrator::rewindSpawns()
+{
+    m_spawnStream.rewind();
+    record(GridReplayEvent::Rewind);
+}
+
+QList<int> GameGridOrchestrator::peekSpawns(int column, int count) const
+{
+    QList<int> colors;
+    if (column < 0 || column >= m_spawnStream.columnCount() || count <= 0)
+        return colors;
+    colors.reserve(count);
+    for (const quint8 color : m_spawnStream.peek(column, count))
+        colors.append(color - 1);
+    return colors;
+}
+
+QList<int> GameGridOrchestrator::spawnPosition() const
+{
+    QList<int> positions;
+    positions.reserve(m_spawnStream.columnCount());
+    for (const quint32 position : m_spawnStream.positions())
+        positions.append(static_cast<int>(position));
+    return positions;
+}
+
+void GameGridOrchestrator::restoreSpawnPosition(const QList<int> &positions)
+{
+    QVector<quint32> counters;
+    counters.reserve(positions.size());
+    for (const int position : positions)
+        counters.append(static_cast<quint32>(position));
+    m_spawnStream.setPositions(counters);
+    recordState(GridReplayEvent::Positions);
+}
+
+void GameGridOrchestrator::resetBoard()
+{
+    m_board = GridBoard(m_rowCount, m_columnCount, m_paletteKeys);
+    m_matchTracker.reset(m_board);
+    m_moveIndex.reset(m_board);
+    record(GridReplayEvent::Reset);
+    emit boardChanged();
+}
+
+void GameGridOrchestrator::loadBoard(const QVariantList &matrixVariant)
+{
+    m_board = toBoard(matrixVariant);
+    m_matchTracker.reset(m_board);
+    m_moveIndex.reset(m_board);
+    recordState(GridReplayEvent::Board);
+    emit boardChanged();
+}
+
+bool GameGridOrchestrator::applySwap(int row1, int column1, int row2, int column2)
+{
+    if (!m_board.contains(row1, column1) || !m_board.contains(row2, column2))
+        return false;
+    if (row1 == row2 && column1 == column2)
+        return false;
 
-    const int total = qMax(m_rowCount * m_columnCount * 4, m_palette.size());
-    m_spawnPool.reserve(total);
-    quint32 localSeed = m_seed;
-    for (int i = 0; i < total; ++i) {
-        localSeed = (localSeed * kLcgMultiplier + kLcgIncrement) & kLcgModulus;
-        const double value = static_cast<double>(localSeed) / static_cast<double>(kLcgModulus);
-        const int index = static_cast<int>(value * m_palette.size()) % m_palette.size();
-        m_spawnPool.append(m_palette.at(index));
+    m_board.swapCells(row1, column1, row2, column2);
+    touchCell(row1, column1);
+    touchCell(row2, column2);
+    recordArguments(GridReplayEvent::Swap, { row1, column1, row2, column2 });
+    emit boardChanged();
+    return true;
+}
+
+int GameGridOrchestrator::clearCells(const QList<int> &cells)
+{
+    int changed = 0;
+    for (int i = 0; i + 1 < cells.size(); i += 2) {
+        if (setCell(cells.at(i), cells.at(i + 1), GridBoard::EmptyCell))
+            ++changed;
     }
+    if (changed) {
+        recordArguments(GridReplayEvent::Clear, cells);
+        emit boardChanged();
+    }
+    return changed;
 }
 
-QVector<QVector<QString>> GameGridOrchestrator::toMatrix(const QVariantList &matrixVariant) const
+int GameGridOrchestrator::commitMoves(const QList<int> &moves)
 {
-    QVector<QVector<QString>> matrix(m_rowCount, QVector<QString>(m_columnCount));
-    const int rows = std::min<int>(matrixVariant.size(), m_rowCount);
-    for (int r = 0; r < rows; ++r) {
-        const QVariantList rowList = matrixVariant.at(r).toList();
-        const int columns = std::min<int>(rowList.size(), m_columnCount);
-        for (int c = 0; c < columns; ++c) {
-            matrix[r][c] = rowList.at(c).toString();
-        }
+    int changed = 0;
+    for (int i = 0; i + 2 < moves.size(); i += kTripletStride) {
+        const int fromRow = moves.at(i);
+        const int toRow = moves.at(i + 1);
+        const int column = moves.at(i + 2);
+        if (fromRow == toRow || !m_board.contains(fromRow, column) || !m_board.contains(toRow, column))
+            continue;
+        const quint8 value = m_board.at(fromRow, column);
+        setCell(toRow, column, value);
+        setCell(fromRow, column, GridBoard::EmptyCell);
+        ++changed;
+    }
+    if (changed) {
+        recordArguments(GridReplayEvent::Moves, moves);
+        emit boardChanged();
     }
-    return matrix;
+    return changed;
 }
 
-QVariantList GameGridOrchestrator::prepareFillInternal(QVector<QVector<QString>> &matrix)
+int GameGridOrchestrator::commitSpawns(const QList<int> &spawns)
 {
-    QVariantList instructions;
-    if (m_rowCount <= 0 || m_columnCount <= 0)
-        return instructions;
-
-    const int spawnRow = (m_fillDirection >= 0) ? -1 : m_rowCount;
-    if (m_fillDirection >= 0) {
-        for (int column = 0; column < m_columnCount; ++column) {
-            for (int row = m_rowCount - 1; row >= 0; --row) {
-                if (!matrix[row][column].isEmpty())
-                    continue;
-                const ColorEntry entry = chooseFromPool(matrix, row, column);
-                matrix[row][column] = entry.key;
-
-                QVariantMap spec;
-                spec.insert(QStringLiteral("colorKey"), entry.key);
-                spec.insert(QStringLiteral("colorHex"), entry.hex);
-                spec.insert(QStringLiteral("hp"), kDefaultHp);
-
-                QVariantMap op;
-                op.insert(QStringLiteral("column"), column);
-                op.insert(QStringLiteral("targetRow"), row);
-                op.insert(QStringLiteral("spawnRow"), spawnRow);
-                op.insert(QStringLiteral("spec"), spec);
-                instructions.append(op);
-            }
-        }
-    } else {
-        for (int column = 0; column < m_columnCount; ++column) {
-            for (int row = 0; row < m_rowCount; ++row) {
-                if (!matrix[row][column].isEmpty())
-                    continue;
-                const ColorEntry entry = chooseFromPool(matrix, row, column);
-                matrix[row][column] = entry.key;
-
-                QVariantMap spec;
-                spec.insert(QStringLiteral("colorKey"), entry.key);
-                spec.insert(QStringLiteral("colorHex"), entry.hex);
-                spec.insert(QStringLiteral("hp"), kDefaultHp);
-
-                QVariantMap op;
-                op.insert(QStringLiteral("column"), column);
-                op.insert(QStringLiteral("targetRow"), row);
-                op.insert(QStringLiteral("spawnRow"), spawnRow);
-                op.insert(QStringLiteral("spec"), spec);
-                instructions.append(op);
-            }
+    int changed = 0;
+    for (int i = 0; i + 2 < spawns.size(); i += kTripletStride) {
+        const int color = spawns.at(i + 2);
+        if (color < 0 || color >= m_board.palette().size())
+            continue;
+        if (setCell(spawns.at(i), spawns.at(i + 1), static_cast<quint8>(color + 1)))
+            ++changed;
+    }
+    if (changed) {
+        recordArguments(GridReplayEvent::Spawns, spawns);
+        emit boardChanged();
+    }
+    return changed;
+}
+
+QList<int> GameGridOrchestrator::planSpawns(int row)
+{
+    const QList<GridSpawn> &spawns = planSpawnList(row);
+    QList<int> packed;
+    packed.reserve(spawns.size() * kTripletStride);
+    for (const GridSpawn &spawn : spawns)
+        packed << spawn.column << spawn.targetRow << spawn.color - 1;
+    return packed;
+}
+
+QList<int> GameGridOrchestrator::planCompaction()
+{
+    const QList<GridMove> &moves = planCompactionList();
+    QList<int> packed;
+    packed.reserve(moves.size() * kTripletStride);
+    for (const GridMove &move : moves)
+        packed << move.fromRow << move.toRow << move.column;
+    return packed;
+}
+
+QList<int> GameGridOrchestrator::boardMatches()
+{
+    const QList<GridMatch> &matches = boardMatchList();
+    QList<int> packed;
+    packed.reserve(matches.size() * kTripletStride);
+    for (const GridMatch &match : matches)
+        packed << match.row << match.column << match.color - 1;
+    return packed;
+}
+
+QList<int> GameGridOrchestrator::boardMatchShapes()
+{
+    const QList<GridMatchShape> &shapes = matchShapeList();
+    QList<int> packed;
+    packed.reserve(shapes.size() * kShapeStride);
+    for (const GridMatchShape &shape : shapes) {
+        packed << shape.shape << shape.color - 1 << shape.size << shape.length
+               << shape.top << shape.left << shape.bottom << shape.right;
+    }
+    return packed;
+}
+
+const QList<GridSpawn> &GameGridOrchestrator::planSpawnList(int row)
+{
+    // Plan against a scratch copy so later picks in the row see earlier ones.
+    m_spawnBuffer.clear();
+    m_scratch = m_board;
+    planRowSpawns(m_scratch, row, m_spawnBuffer);
+    if (!m_spawnBuffer.isEmpty())
+        recordState(GridReplayEvent::Positions);
+    return m_spawnBuffer;
+}
+
+const QList<GridMove> &GameGridOrchestrator::planCompactionList()
+{
+    m_moveBuffer.clear();
+    m_scratch = m_board;
+    GridSimulation::compact(m_scratch, m_fillDirection, m_moveBuffer, m_largeBoard);
+    return m_moveBuffer;
+}
+
+const QList<GridMatch> &GameGridOrchestrator::boardMatchList()
+{
+    // Only the rows and columns touched since the last query are rescanned.
+    m_matchBuffer.clear();
+    const int count = m_matchTracker.update(m_board, m_largeBoard);
+    m_matchBuffer.reserve(count);
+    m_matchTracker.forEachMatch([this](int row, int column) {
+        GridMatch match;
+        match.row = row;
+        match.column = column;
+        match.color = m_board.at(row, column);
+        m_matchBuffer.append(match);
+    });
+
+    if (m_verifyMatches) {
+        QList<GridMatch> expected;
+        detectMatchesInternal(m_board, expected);
+        if (expected != m_matchBuffer) {
+            qWarning() << "GameGridOrchestrator: incremental match scan found" << m_matchBuffer.size()
+                       << "cells, full scan found" << expected.size();
+            m_matchBuffer = expected;
+            m_matchTracker.reset(m_board);
         }
     }
+    return m_matchBuffer;
+}
 
-    return instructions;
+const QList<GridMatchShape> &GameGridOrchestrator::matchShapeList()
+{
+    m_shapeBuffer.clear();
+    m_matchShapes.analyze(m_board, m_shapeBuffer);
+    return m_shapeBuffer;
+}
+
+int GameGridOrchestrator::swapScore(int row1, int column1, int row2, int column2)
+{
+    if (!m_board.contains(row1, column1) || !m_board.contains(row2, column2))
+        return 0;
+    if (qAbs(row1 - row2) + qAbs(column1 - column2) != 1)
+        return 0;
+    return GridSimulation::swapScore(m_board, row1, column1, row2, column2);
+}
+
+QList<int> GameGridOrchestrator::rankSwaps(int limit)
+{
+    const QList<GridSwap> &swaps = rankSwapList(limit);
+    QList<int> packed;
+    packed.reserve(swaps.size() * kRecordStride);
+    for (const GridSwap &swap : swaps)
+        packed << swap.row1 << swap.column1 << swap.row2 << swap.column2 << swap.score;
+    return packed;
+}
+
+const QList<GridSwap> &GameGridOrchestrator::rankSwapList(int limit)
+{
+    // Only indexed swaps can score, so the rest of the board is skipped.
+    m_swapBuffer.clear();
+    m_moveIndex.update(m_board);
+    m_swapBuffer.reserve(m_moveIndex.moveCount());
+    m_moveIndex.forEachMove([this](int row1, int column1, int row2, int column2) {
+        GridSwap swap;
+        swap.row1 = row1;
+        swap.column1 = column1;
+        swap.row2 = row2;
+        swap.column2 = column2;
+        swap.score = GridSimulation::swapScore(m_board, row1, column1, row2, column2);
+        m_swapBuffer.append(swap);
+    });
+    GridSimulation::sortSwaps(m_swapBuffer, limit);
+    return m_swapBuffer;
+}
+
+int GameGridOrchestrator::legalMoveCount()
+{
+    return m_moveIndex.update(m_board);
+}
+
+QList<int> GameGridOrchestrator::legalSwaps(int limit)
+{
+    QList<int> packed;
+    m_moveIndex.update(m_board);
+    m_moveIndex.forEachMove([&packed, limit](int row1, int column1, int row2, int column2) {
+        if (limit > 0 && packed.size() >= limit * 4)
+            return;
+        packed << row1 << column1 << row2 << column2;
+    });
+    return packed;
+}
+
+QList<int> GameGridOrchestrator::reshuffle()
+{
+    cancelPlanning();
+    GridBoard board(m_rowCount, m_columnCount, m_paletteKeys);
+    for (int attempt = 0; attempt < kMaxReshuffleAttempts; ++attempt) {
+        if (GridSimulation::generateBoard(board, m_spawnStream))
+            break;
+    }
+
+    m_board = board;
+    m_matchTracker.reset(m_board);
+    m_moveIndex.reset(m_board);
+    record(GridReplayEvent::Reshuffle);
+    emit boardChanged();
+    return packedCells();
 }
 
-QVariantList GameGridOrchestrator::compactionMovesInternal(QVector<QVector<QString>> &matrix) const
-{
-    QVariantList moves;
-    if (m_rowCount <= 0 || m_columnCount <= 0)
-        return moves;
-
-    if (m_fillDirection >= 0) {
-        for (int column = 0; column < m_columnCount; ++column) {
-            int writeRow = m_rowCount - 1;
-            for (int row = m_rowCount - 1; row >= 0; --row) {
-                const QString &value = matrix[row][column];
-                if (value.isEmpty())
-                    continue;
-                if (row != writeRow) {
-                    QVariantMap move;
-                    move.insert(QStringLiteral("fromRow"), row);
-                    move.insert(QStringLiteral("toRow"), writeRow);
-                    move.insert(QStringLiteral("column"), column);
-                    moves.append(move);
-                    matrix[writeRow][column] = value;
-                    matrix[row][column].clear();
-                }
-                --writeRow;
-            }
-            for (int row = writeRow; row >= 0; --row)
-                matrix[row][column].clear();
+int GameGridOrchestrator::snapshot()
+{
+    BoardSnapshot snapshot;
+    snapshot.board = m_board;
+    snapshot.spawns = m_spawnStream;
+    snapshot.matchTracker = m_matchTracker;
+    snapshot.moveIndex = m_moveIndex;
+    const int id = m_nextSnapshotId++;
+    m_snapshots.insert(id, snapshot);
+    return id;
+}
+
+QList<int> GameGridOrchestrator::restore(int id)
+{
+    if (!m_snapshots.contains(id))
+        return {};
+    const BoardSnapshot snapshot = m_snapshots.value(id);
+    if (snapshot.board.rowCount() != m_rowCount || snapshot.board.columnCount() != m_columnCount)
+        return {};
+
+    cancelPlanning();
+    m_board = snapshot.board;
+    m_spawnStream = snapshot.spawns;
+    m_matchTracker = snapshot.matchTracker;
+    m_moveIndex = snapshot.moveIndex;
+    recordState(GridReplayEvent::Board);
+    emit boardChanged();
+    return packedCells();
+}
+
+void GameGridOrchestrator::releaseSnapshot(int id)
+{
+    m_snapshots.remove(id);
+}
+
+GameGridOrchestrator *GameGridOrchestrator::fork() const
+{
+    auto *copy = new GameGridOrchestrator;
+    copy->m_palette = m_palette;
+    copy->m_paletteKeys = m_paletteKeys;
+    copy->m_rowCount = m_rowCount;
+    copy->m_columnCount = m_columnCount;
+    copy->m_fillDirection = m_fillDirection;
+    copy->m_seed = m_seed;
+    copy->m_verifyMatches = m_verifyMatches;
+    copy->m_largeBoard = m_largeBoard;
+    copy->m_board = m_board;
+    copy->m_spawnStream = m_spawnStream;
+    copy->m_matchTracker = m_matchTracker;
+    copy->m_moveIndex = m_moveIndex;
+    return copy;
+}
+
+void GameGridOrchestrator::planTurn(int swapCount, int budgetMs)
+{
+    cancelPlanning();
+
+    const GridSimulation root(m_board, m_spawnStream, m_fillDirection);
+    const QSharedPointer<GridTurnSearch> search = QSharedPointer<GridTurnSearch>::create(root, swapCount, budgetMs);
+    m_search = search;
+    m_searches.append(search);
+    emit planningChanged();
+
+    const GridTurnSearch *token = search.data();
+    GridTurnSearch::start(search, QThreadPool::globalInstance(), [this, token](const GridTurnPlan &plan) {
+        QMetaObject::invokeMethod(this, [this, token, plan]() { finishPlanning(token, plan); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void GameGridOrchestrator::planCpuSwap(int lookaheadSwaps, int searchBudgetMs, int swapsRemaining)
+{
+    GridCpuPolicy policy;
+    policy.lookaheadSwaps = lookaheadSwaps;
+    policy.searchBudgetMs = searchBudgetMs;
+    if (!policy.isGreedy()) {
+        planTurn(policy.searchDepth(swapsRemaining), searchBudgetMs);
+        return;
+    }
+
+    cancelPlanning();
+    const QList<GridSwap> &ranked = rankSwapList(1);
+    QList<int> packed;
+    int score = 0;
+    if (!ranked.isEmpty()) {
+        const GridSwap &swap = ranked.first();
+        packed << swap.row1 << swap.column1 << swap.row2 << swap.column2;
+        score = swap.score;
+    }
+    emit turnPlanned(packed, score);
+}
+
+void GameGridOrchestrator::setReplayWriter(const QSharedPointer<GridReplayWriter> &writer, int grid)
+{
+    m_replayWriter = writer;
+    m_replayGrid = grid;
+    if (!m_replayWriter)
+        return;
+
+    GridReplayEvent event;
+    event.kind = GridReplayEvent::Grid;
+    event.grid = grid;
+    event.values << quint64(m_rowCount) << quint64(m_columnCount) << GridReplayEvent::zigzag(m_fillDirection)
+                 << m_seed << quint64(m_largeBoard);
+    for (const ColorEntry &entry : std::as_const(m_palette))
+        event.strings << entry.key << entry.hex << QString::number(entry.weight, 'g', 17);
+    m_replayWriter->write(event);
+    recordState(GridReplayEvent::Board);
+}
+
+void GameGridOrchestrator::recordTurnEnd()
+{
+    record(GridReplayEvent::TurnEnd, { m_board.hash() });
+}
+
+void GameGridOrchestrator::recordPowerup(int slot)
+{
+    record(GridReplayEvent::Powerup, { GridReplayEvent::zigzag(slot) });
+}
+
+bool GameGridOrchestrator::replayEvent(const GridReplayEvent &event)
+{
+    const QVector<quint64> &values = event.values;
+    QList<int> arguments;
+    switch (event.kind) {
+    case GridReplayEvent::Swap:
+    case GridReplayEvent::Clear:
+    case GridReplayEvent::Moves:
+    case GridReplayEvent::Spawns:
+        arguments.reserve(values.size());
+        for (const quint64 value : values)
+            arguments.append(int(GridReplayEvent::unzigzag(value)));
+        break;
+    default:
+        break;
+    }
+
+    switch (event.kind) {
+    case GridReplayEvent::Grid: {
+        if (values.size() < 5 || event.strings.size() % 3 != 0)
+            return false;
+        QVariantList palette;
+        for (int i = 0; i + 2 < event.strings.size(); i += 3) {
+            QVariantMap entry;
+            entry.insert(QStringLiteral("key"), event.strings.at(i));
+            entry.insert(QStringLiteral("hex"), event.strings.at(i + 1));
+            entry.insert(QStringLiteral("weight"), event.strings.at(i + 2).toDouble());
+            palette.append(entry);
         }
-    } else {
-        for (int column = 0; column < m_columnCount; ++column) {
-            int writeRow = 0;
-            for (int row = 0; row < m_rowCount; ++row) {
-                const QString &value = matrix[row][column];
-                if (value.isEmpty())
-                    continue;
-                if (row != writeRow) {
-                    QVariantMap move;
-                    move.insert(QStringLiteral("fromRow"), row);
-                    move.insert(QStringLiteral("toRow"), writeRow);
-                    move.insert(QStringLiteral("column"), column);
-                    moves.append(move);
-                    matrix[writeRow][column] = value;
-                    matrix[row][column].clear();
-                }
-                ++writeRow;
-            }
-            for (int row = writeRow; row < m_rowCount; ++row)
-                matrix[row][column].clear();
+        setRowCount(int(values.at(0)));
+        setColumnCount(int(values.at(1)));
+        setFillDirection(int(GridReplayEvent::unzigzag(values.at(2))));
+        setSpawnPalette(palette);
+        setSpawnSeed(quint32(values.at(3)));
+        setLargeBoard(values.at(4) != 0);
+        return m_rowCount == int(values.at(0)) && m_columnCount == int(values.at(1));
+    }
+    case GridReplayEvent::Seed:
+        if (values.size() != 1)
+            return false;
+        setSpawnSeed(quint32(values.at(0)));
+        return true;
+    case GridReplayEvent::Rewind:
+        rewindSpawns();
+        return true;
+    case GridReplayEvent::Positions:
+    case GridReplayEvent::Board: {
+        const int cells = event.kind == GridReplayEvent::Board ? m_board.cellCount() : 0;
+        if (values.size() != cells + m_spawnStream.columnCount())
+            return false;
+        // Cells hold 0 for empty or a 1-based palette index; reject the
+        // record before touching any state when one is out of range.
+        for (int i = 0; i < cells; ++i) {
+            if (values.at(i) > quint64(m_palette.size()))
+                return false;
         }
+        QVector<quint32> counters;
+        counters.reserve(m_spawnStream.columnCount());
+        for (int i = cells; i < values.size(); ++i)
+            counters.append(quint32(values.at(i)));
+        m_spawnStream.setPositions(counters);
+        if (event.kind == GridReplayEvent::Positions)
+            return true;
+        GridBoard board(m_rowCount, m_columnCount, m_paletteKeys);
+        for (int i = 0; i < cells; ++i)
+            board.set(i / m_columnCount, i % m_columnCount, quint8(values.at(i)));
+        cancelPlanning();
+        m_board = board;
+        m_matchTracker.reset(m_board);
+        m_moveIndex.reset(m_board);
+        emit boardChanged();
+        return true;
+    }
+    case GridReplayEvent::Reset:
+        resetBoard();
+        return true;
+    case GridReplayEvent::Swap:
+        return arguments.size() == 4
+            && applySwap(arguments.at(0), arguments.at(1), arguments.at(2), arguments.at(3));
+    case GridReplayEvent::Clear:
+        clearCells(arguments);
+        return true;
+    case GridReplayEvent::Moves:
+        commitMoves(arguments);
+        return true;
+    case GridReplayEvent::Spawns:
+        commitSpawns(arguments);
+        return true;
+    case GridReplayEvent::Cascade:
+        resolveCascadeList();
+        return true;
+    case GridReplayEvent::Reshuffle:
+        reshuffle();
+        return true;
+    case GridReplayEvent::TurnEnd:
+    case GridReplayEvent::Powerup:
+        return true;
+    default:
+        return false;
     }
+}
 
-    return moves;
+void GameGridOrchestrator::record(int kind, const QVector<quint64> &values)
+{
+    if (m_replayWriter)
+        m_replayWriter->write(kind, m_replayGrid, values);
 }
 
-QVariantList GameGridOrchestrator::detectMatchesInternal(const QVector<QVector<QString>> &matrix) const
+void GameGridOrchestrator::recordArguments(int kind, const QList<int> &arguments)
 {
-    QVariantList matches;
-    if (m_rowCount <= 0 || m_columnCount <= 0)
-        return matches;
+    if (!m_replayWriter)
+        return;
+    QVector<quint64> values;
+    values.reserve(arguments.size());
+    for (const int argument : arguments)
+        values.append(GridReplayEvent::zigzag(argument));
+    m_replayWriter->write(kind, m_replayGrid, values);
+}
 
-    QSet<QString> seen;
+void GameGridOrchestrator::recordState(int kind)
+{
+    // Board records carry every cell before the counters; Positions only
+    // the counters.
+    if (!m_replayWriter)
+        return;
+    QVector<quint64> values;
+    if (kind == GridReplayEvent::Board) {
+        values.reserve(m_board.cellCount() + m_spawnStream.columnCount());
+        for (int row = 0; row < m_board.rowCount(); ++row) {
+            const quint8 *cells = m_board.rowData(row);
+            for (int column = 0; column < m_board.columnCount(); ++column)
+                values.append(cells[column]);
+        }
+    }
+    for (const quint32 position : m_spawnStream.positions())
+        values.append(position);
+    m_replayWriter->write(kind, m_replayGrid, values);
+}
 
-    // Horizontal runs
+QList<int> GameGridOrchestrator::packedCells() const
+{
+    QList<int> packed;
+    packed.reserve(m_board.cellCount() * kTripletStride);
     for (int row = 0; row < m_rowCount; ++row) {
-        int column = 0;
-        while (column < m_columnCount) {
-            const QString &value = matrix[row][column];
-            if (value.isEmpty()) {
-                ++column;
-                continue;
-            }
-            int runEnd = column + 1;
-            while (runEnd < m_columnCount && matrix[row][runEnd] == value)
-                ++runEnd;
-            if (runEnd - column >= 3) {
-                for (int c = column; c < runEnd; ++c) {
-                    const QString key = QString::number(row) + QLatin1Char(':') + QString::number(c);
-                    seen.insert(key);
-                }
-            }
-            column = runEnd;
-        }
+        for (int column = 0; column < m_columnCount; ++column)
+            packed << row << column << int(m_board.at(row, column)) - 1;
     }
+    return packed;
+}
 
-    // Vertical runs
-    for (int column = 0; column < m_columnCount; ++column) {
-        int row = 0;
-        while (row < m_rowCount) {
-            const QString &value = matrix[row][column];
-            if (value.isEmpty()) {
-                ++row;
-                continue;
-            }
-            int runEnd = row + 1;
-            while (runEnd < m_rowCount && matrix[runEnd][column] == value)
-                ++runEnd;
-            if (runEnd - row >= 3) {
-                for (int r = row; r < runEnd; ++r) {
-                    const QString key = QString::number(r) + QLatin1Char(':') + QString::number(column);
-                    seen.insert(key);
-                }
-            }
-            row = runEnd;
+void GameGridOrchestrator::cancelPlanning()
+{
+    if (!m_search)
+        return;
+    // The abandoned search still reports back; finishPlanning drops it
+    // from m_searches and ignores its plan.
+    m_search->cancel();
+    m_search.reset();
+    emit planningChanged();
+}
+
+void GameGridOrchestrator::finishPlanning(const GridTurnSearch *search, const GridTurnPlan &plan)
+{
+    for (int i = 0; i < m_searches.size(); ++i) {
+        if (m_searches.at(i).data() == search) {
+            m_searches.removeAt(i);
+            break;
         }
     }
+    if (m_search.data() != search)
+        return;
+    m_search.reset();
 
-    for (const QString &entry : seen) {
-        const QStringList parts = entry.split(QLatin1Char(':'));
-        if (parts.size() != 2)
-            continue;
-        QVariantMap map;
-        map.insert(QStringLiteral("row"), parts.at(0).toInt());
-        map.insert(QStringLiteral("column"), parts.at(1).toInt());
-        matches.append(map);
+    QList<int> packed;
+    packed.reserve(plan.swaps.size() * 4);
+    for (const GridSwap &swap : plan.swaps)
+        packed << swap.row1 << swap.column1 << swap.row2 << swap.column2;
+    emit planningChanged();
+    emit turnPlanned(packed, plan.score);
+}
+
+QList<int> GameGridOrchestrator::resolveCascade()
+{
+    return packTimeline(resolveCascadeList());
+}
+
+QList<int> GameGridOrchestrator::packTimeline(const QList<GridCascadeEvent> &events)
+{
+    QList<int> packed;
+    packed.reserve(events.size() * kRecordStride);
+    for (const GridCascadeEvent &event : events) {
+        const int value = event.kind == GridCascadeEvent::Move ? event.toRow : event.color - 1;
+        packed << event.step << event.kind << event.row << event.column << value;
     }
+    return packed;
+}
 
-    return matches;
+const QList<GridCascadeEvent> &GameGridOrchestrator::resolveCascadeList()
+{
+    GridSimulation simulation;
+    m_timelineBuffer.clear();
+    if (beginCascade(simulation))
+        simulation.settle(&m_timelineBuffer);
+    return commitCascade(simulation, m_timelineBuffer);
 }
 
-GameGridOrchestrator::ColorEntry GameGridOrchestrator::chooseFromPool(QVector<QVector<QString>> &matrix, int row, int column)
+bool GameGridOrchestrator::beginCascade(GridSimulation &simulation) const
 {
-    if (m_spawnPool.isEmpty())
-        rebuildPool();
+    if (!m_board.isValid())
+        return false;
+    simulation = GridSimulation(m_board, m_spawnStream, m_fillDirection);
+    simulation.setLargeBoard(m_largeBoard);
+    return true;
+}
 
-    if (m_spawnPool.isEmpty())
-        return { QStringLiteral("red"), QStringLiteral("#ef4444") };
+const QList<GridCascadeEvent> &GameGridOrchestrator::commitCascade(const GridSimulation &simulation,
+                                                                   const QList<GridCascadeEvent> &timeline)
+{
+    m_timelineBuffer = timeline;
+    if (m_timelineBuffer.isEmpty())
+        return m_timelineBuffer;
 
-    const int poolSize = m_spawnPool.size();
-    for (int attempt = 0; attempt < poolSize; ++attempt) {
-        const ColorEntry &candidate = m_spawnPool.at(m_poolIndex % poolSize);
-        m_poolIndex = (m_poolIndex + 1) % poolSize;
-        if (!wouldCreateMatch(matrix, row, column, candidate.key))
-            return candidate;
+    m_board = simulation.board();
+    m_spawnStream = simulation.spawns();
+    record(GridReplayEvent::Cascade);
+    if (m_largeBoard) {
+        m_matchTracker.markAllDirty();
+        m_moveIndex.markAllDirty();
+    } else {
+        for (const GridCascadeEvent &event : std::as_const(m_timelineBuffer)) {
+            touchCell(event.row, event.column);
+            if (event.kind == GridCascadeEvent::Move)
+                touchCell(event.toRow, event.column);
+        }
     }
+    emit boardChanged();
 
-    // Fallback to first palette entry if every candidate would create a match
-    return m_palette.isEmpty() ? ColorEntry{ QStringLiteral("gray"), QStringLiteral("#737373") }
-                               : m_palette.first();
+    // A settled cascade leaves the board full.
+    if (m_moveIndex.update(m_board) == 0)
+        emit noMovesAvailable();
+    return m_timelineBuffer;
 }
 
-bool GameGridOrchestrator::wouldCreateMatch(const QVector<QVector<QString>> &matrix, int row, int column, const QString &colorKey) const
+bool GameGridOrchestrator::setCell(int row, int column, quint8 value)
 {
-    if (colorKey.isEmpty())
+    if (!m_board.contains(row, column) || m_board.at(row, column) == value)
         return false;
+    m_board.set(row, column, value);
+    touchCell(row, column);
+    return true;
+}
 
-    int count = 1;
-    for (int c = column - 1; c >= 0; --c) {
-        if (matrix[row][c] == colorKey)
-            ++count;
-        else
-            break;
-    }
-    for (int c = column + 1; c < m_columnCount; ++c) {
-        if (matrix[row][c] == colorKey)
-            ++count;
-        else
-            break;
-    }
-    if (count >= 3)
-        return true;
+void GameGridOrchestrator::touchCell(int row, int column)
+{
+    m_matchTracker.markCellDirty(row, column);
+    m_moveIndex.markCellDirty(row, column);
+    emit cellChanged(row, column);
+}
 
-    count = 1;
-    for (int r = row - 1; r >= 0; --r) {
-        if (matrix[r][column] == colorKey)
-            ++count;
-        else
-            break;
+GridBoard GameGridOrchestrator::toBoard(const QVariantList &matrixVariant) const
+{
+    return GridBoard::fromMatrix(matrixVariant, m_rowCount, m_columnCount, m_paletteKeys);
+}
+
+QVariantMap GameGridOrchestrator::spawnSpec(quint8 color) const
+{
+    // Board values are 1-based palette indices; anything outside the spawn
+    // palette falls back to the neutral entry.
+    const bool known = color != GridBoard::EmptyCell && color <= m_palette.size();
+    const ColorEntry entry = known ? m_palette.at(color - 1)
+                                   : ColorEntry{ QStringLiteral("gray"), QStringLiteral("#737373") };
+
+    QVariantMap spec;
+    spec.insert(QStringLiteral("colorKey"), entry.key);
+    spec.insert(QStringLiteral("colorHex"), entry.hex);
+    spec.insert(QStringLiteral("hp"), kDefaultHp);
+    return spec;
+}
+
+void GameGridOrchestrator::planRowSpawns(GridBoard &board, int row, QList<GridSpawn> &spawns)
+{
+    if (row < 0 || row >= board.rowCount())
+        return;
+
+    const int spawnRow = (m_fillDirection >= 0) ? -1 : board.rowCount();
+    for (int column = 0; column < board.columnCount(); ++column) {
+        if (!board.isEmpty(row, column))
+            continue;
+        const quint8 color = chooseSpawn(board, row, column);
+        board.set(row, column, color);
+
+        GridSpawn spawn;
+        spawn.column = column;
+        spawn.targetRow = row;
+        spawn.spawnRow = spawnRow;
+        spawn.color = color;
+        spawn.hp = kDefaultHp;
+        spawns.append(spawn);
     }
-    for (int r = row + 1; r < m_rowCount; ++r) {
-        if (matrix[r][column] == colorKey)
-            ++count;
-        else
-            break;
+}
+
+void GameGridOrchestrator::prepareFillInternal(GridBoard &board, QList<GridSpawn> &spawns)
+{
+    if (!board.isValid())
+        return;
+
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    const int spawnRow = (m_fillDirection >= 0) ? -1 : rows;
+    const int firstRow = (m_fillDirection >= 0) ? rows - 1 : 0;
+    const int step = (m_fillDirection >= 0) ? -1 : 1;
+
+    for (int column = 0; column < columns; ++column) {
+        for (int row = firstRow; row >= 0 && row < rows; row += step) {
+            if (!board.isEmpty(row, column))
+                continue;
+            const quint8 color = chooseSpawn(board, row, column);
+            board.set(row, column, color);
+
+            GridSpawn spawn;
+            spawn.column = column;
+            spawn.targetRow = row;
+            spawn.spawnRow = spawnRow;
+            spawn.color = color;
+            spawn.hp = kDefaultHp;
+            spawns.append(spawn);
+        }
     }
-    return count >= 3;
 }
+
+void GameGridOrchestrator::detectMatchesInternal(const GridBoard &board, QList<GridMatch> &matches) const
+{
+    if (countMatches(board) == 0)
+        return;
+
+    matches.reserve(matches.size() + m_matchKernel.matchCount());
+    m_matchKernel.forEachMatch([&board, &matches](int row, int column) {
+        GridMatch match;
+        match.row = row;
+        match.column = column;
+        match.color = board.at(row, column);
+        matches.append(match);
+    });
+}
+
+int GameGridOrchestrator::countMatches(const GridBoard &board) const
+{
+    m_matchKernel.load(board, m_largeBoard);
+    return m_matchKernel.detect(m_largeBoard);
+}
+
+quint8 GameGridOrchestrator::chooseSpawn(const GridBoard &board, int row, int column)
+{
+    return GridSimulation::pickSpawn(board, row, column, m_spawnStream);
+}
+
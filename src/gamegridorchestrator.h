@@ -2,7 +2,18 @@
 #define GAMEGRIDORCHESTRATOR_H
 
 #include "abstractgameelement.h"
+#include "gridboard.h"
+#include "gridinstructions.h"
+#include "gridmatchkernel.h"
+#include "gridmatchshapes.h"
+#include "gridmatchtracker.h"
+#include "gridmoveindex.h"
+#include "gridreplay.h"
+#include "gridsimulation.h"
+#include "gridturnsearch.h"
+#include <QHash>
 #include <QVariantList>
+#include <QSharedPointer>
 #include <QVariantMap>
 #include <QVector>
 
@@ -13,9 +24,19 @@ class GameGridOrchestrator : public AbstractGameElement
     Q_PROPERTY(int columnCount READ columnCount WRITE setColumnCount NOTIFY columnCountChanged)
     Q_PROPERTY(int fillDirection READ fillDirection WRITE setFillDirection NOTIFY fillDirectionChanged)
     Q_PROPERTY(quint32 spawnSeed READ spawnSeed WRITE setSpawnSeed NOTIFY spawnSeedChanged)
+    Q_PROPERTY(GridBoard board READ board NOTIFY boardChanged)
+    Q_PROPERTY(QString boardHash READ boardHashText NOTIFY boardChanged)
+    Q_PROPERTY(QVariantList spawnPalette READ spawnPalette WRITE setSpawnPalette NOTIFY paletteChanged)
+    Q_PROPERTY(QStringList paletteKeys READ paletteKeys NOTIFY paletteChanged)
+    Q_PROPERTY(QStringList paletteColors READ paletteColors NOTIFY paletteChanged)
+    Q_PROPERTY(int spawnHp READ spawnHp CONSTANT)
+    Q_PROPERTY(bool verifyMatches READ verifyMatches WRITE setVerifyMatches NOTIFY verifyMatchesChanged)
+    Q_PROPERTY(bool planning READ isPlanning NOTIFY planningChanged)
+    Q_PROPERTY(bool largeBoard READ isLargeBoard WRITE setLargeBoard NOTIFY largeBoardChanged)
 
 public:
     explicit GameGridOrchestrator(QQuickItem *parent = nullptr);
+    ~GameGridOrchestrator() override;
 
     int rowCount() const { return m_rowCount; }
     void setRowCount(int value);
@@ -29,40 +50,234 @@ public:
     quint32 spawnSeed() const { return m_seed; }
     void setSpawnSeed(quint32 value);
 
+    const GridBoard &board() const { return m_board; }
+    // Zobrist hash of the board, kept up to date by every write. QML gets
+    // it as 16 hex digits since its numbers only hold 53 bits.
+    quint64 boardHash() const { return m_board.hash(); }
+    QString boardHashText() const;
+
+    // Debug aid: when set, every incremental boardMatches() result is
+    // compared against a full kernel scan and mismatches are logged.
+    bool verifyMatches() const { return m_verifyMatches; }
+    void setVerifyMatches(bool value);
+
+    // Spawn colors as { key, hex, weight } maps, at most
+    // GridSpawnStream::MaxColors of them. Weights are relative and default
+    // to 1; a weight of 0 keeps a color on the palette without spawning
+    // it. Changing the keys resets the board, changing only the weights
+    // does not.
+    QVariantList spawnPalette() const;
+    void setSpawnPalette(const QVariantList &entries);
+
+    // Mode for endless boards, up to 1024 x 1024: cascades, compaction and
+    // match scans run in bands across cores (see GridSimulation), and a
+    // resolved cascade reports boardChanged only, without a cellChanged per
+    // cell. Views should read the board through GridBoard::regionMatrix.
+    bool isLargeBoard() const { return m_largeBoard; }
+    void setLargeBoard(bool value);
+
+    const QStringList &paletteKeys() const { return m_paletteKeys; }
+    QStringList paletteColors() const;
+    int spawnHp() const;
+
     Q_INVOKABLE QVariantList prepareFill(const QVariantList &matrixVariant);
     Q_INVOKABLE QVariantList compactionMoves(const QVariantList &matrixVariant);
     Q_INVOKABLE QVariantList detectMatches(const QVariantList &matrixVariant) const;
     Q_INVOKABLE QVariantMap spawnSpecFor(const QVariantList &matrixVariant, int row, int column);
-    Q_INVOKABLE void resetPool();
+    Q_INVOKABLE GridBoard makeBoard(const QVariantList &matrixVariant) const;
+    // Spawn colors come from a counter-based stream with one counter per
+    // column. peekSpawns returns the next full-palette draws of a column as
+    // 0-based palette indices without consuming them; actual spawns draw
+    // among the colors that do not complete a match instead. The position
+    // is the per-column counter list and can be saved and restored.
+    Q_INVOKABLE void rewindSpawns();
+    Q_INVOKABLE QList<int> peekSpawns(int column, int count) const;
+    Q_INVOKABLE QList<int> spawnPosition() const;
+    Q_INVOKABLE void restoreSpawnPosition(const QList<int> &positions);
+
+    // Owned board. QML mirrors each mutation of its block matrix through
+    // these packed deltas: cells are { row, column } pairs, moves
+    // { fromRow, toRow, column } and spawns { row, column, color } triplets.
+    Q_INVOKABLE void resetBoard();
+    Q_INVOKABLE void loadBoard(const QVariantList &matrixVariant);
+    Q_INVOKABLE bool applySwap(int row1, int column1, int row2, int column2);
+    Q_INVOKABLE int clearCells(const QList<int> &cells);
+    Q_INVOKABLE int commitMoves(const QList<int> &moves);
+    Q_INVOKABLE int commitSpawns(const QList<int> &spawns);
+
+    // Queries against the owned board; none of these commit anything.
+    // Results are packed triplets, see gridinstructions.h; colors are
+    // 0-based indices into paletteKeys/paletteColors.
+    Q_INVOKABLE QList<int> planSpawns(int row);
+    Q_INVOKABLE QList<int> planCompaction();
+    Q_INVOKABLE QList<int> boardMatches();
+    // Matched cells grouped into connected shapes, each packed as
+    // { shape, color, size, length, top, left, bottom, right } with shape
+    // a GridMatchShape::Shape and length the longest run in it.
+    Q_INVOKABLE QList<int> boardMatchShapes();
+    Q_INVOKABLE int swapScore(int row1, int column1, int row2, int column2);
+
+    // Scores every adjacent swap by the cells in the matches it creates,
+    // looking only at the runs through the two swapped cells. Returns the
+    // best limit swaps (all when limit <= 0), best first, as packed
+    // { row1, column1, row2, column2, score } records.
+    Q_INVOKABLE QList<int> rankSwaps(int limit);
+
+    // Swaps that create a match are indexed live from the same deltas as
+    // the match tracker, so these only recheck cells changed since the
+    // last call. legalSwaps packs { row1, column1, row2, column2 } records
+    // in scan order. noMovesAvailable fires when a resolved cascade leaves
+    // a full board without any.
+    Q_INVOKABLE int legalMoveCount();
+    Q_INVOKABLE QList<int> legalSwaps(int limit);
+
+    // Replaces the whole board with a freshly drawn one that has no match
+    // and at least one legal swap. Returns it as { row, column, color }
+    // triplets in row-major order.
+    Q_INVOKABLE QList<int> reshuffle();
+
+    // Copy-on-write snapshots of the board, the spawn stream position and
+    // the live match and move indexes. Taking one copies no cells; the
+    // board's row chunks stay shared until either side writes to them.
+    // restore() puts a snapshot back, keeping it for later restores, and
+    // returns the board as reshuffle() does; it returns nothing for an
+    // unknown id or a snapshot of another board size.
+    Q_INVOKABLE int snapshot();
+    Q_INVOKABLE QList<int> restore(int id);
+    Q_INVOKABLE void releaseSnapshot(int id);
+
+    // A parentless orchestrator with the same settings sharing this
+    // board's chunks, for speculative play that must not touch the live
+    // board. QML owns the returned object; native callers delete it.
+    Q_INVOKABLE GameGridOrchestrator *fork() const;
+
+    // Searches swap sequences of up to swapCount swaps, cascades and
+    // refills included, on the global thread pool. Returns immediately;
+    // turnPlanned delivers the best sequence found within budgetMs as
+    // packed { row1, column1, row2, column2 } records. Starting a new plan
+    // or changing the board size abandons the running one.
+    Q_INVOKABLE void planTurn(int swapCount, int budgetMs);
+    // Plans the CPU player's next move under GridCpuPolicy. A greedy policy
+    // delivers the best-ranked swap through turnPlanned before returning;
+    // otherwise this is planTurn() over the policy's search depth.
+    Q_INVOKABLE void planCpuSwap(int lookaheadSwaps, int searchBudgetMs, int swapsRemaining);
+    Q_INVOKABLE void cancelPlanning();
+    bool isPlanning() const { return !m_search.isNull(); }
+
+    // Runs compact -> fill -> match -> launch on the owned board until it is
+    // stable and commits the result. Returns the timeline as packed
+    // { step, kind, row, column, value } records, kind being a
+    // GridCascadeEvent::Kind; value is the target row for moves and the
+    // 0-based palette index otherwise.
+    Q_INVOKABLE QList<int> resolveCascade();
+
+    // Typed access for native callers. The returned buffers are owned by the
+    // orchestrator and reused by the next call.
+    const QList<GridSpawn> &planSpawnList(int row);
+    const QList<GridMove> &planCompactionList();
+    const QList<GridMatch> &boardMatchList();
+    const QList<GridMatchShape> &matchShapeList();
+    const QList<GridCascadeEvent> &resolveCascadeList();
+    const QList<GridSwap> &rankSwapList(int limit);
+    // The resolveCascade() packing of a timeline.
+    static QList<int> packTimeline(const QList<GridCascadeEvent> &events);
+
+    // While a writer is set, every call that changes the board or the spawn
+    // stream is appended to it as a record for grid, after a Grid record
+    // with the current settings and state; see GridReplayEvent. Settings
+    // changed later are not recorded. A null writer stops recording.
+    void setReplayWriter(const QSharedPointer<GridReplayWriter> &writer, int grid);
+    // Appends a TurnEnd record with the board hash, or a Powerup record.
+    void recordTurnEnd();
+    void recordPowerup(int slot);
+    // Applies one recorded event for this grid, replaying the call that
+    // produced it. TurnEnd and Powerup records change nothing. Returns
+    // false for a malformed or unknown record.
+    bool replayEvent(const GridReplayEvent &event);
+
+    // resolveCascadeList() in two halves, so GameGridBatch can settle
+    // several boards on worker threads: beginCascade() copies the board and
+    // spawn stream into simulation (false when there is no board), and
+    // commitCascade() adopts the settled result with its timeline, updates
+    // the trackers and emits as resolveCascadeList() would.
+    bool beginCascade(GridSimulation &simulation) const;
+    const QList<GridCascadeEvent> &commitCascade(const GridSimulation &simulation,
+                                                 const QList<GridCascadeEvent> &timeline);
 
 signals:
     void rowCountChanged();
     void columnCountChanged();
     void fillDirectionChanged();
     void spawnSeedChanged();
+    void paletteChanged();
+    void boardChanged();
+    void verifyMatchesChanged();
+    void planningChanged();
+    void largeBoardChanged();
+    void turnPlanned(const QList<int> &swaps, int score);
+    void noMovesAvailable();
+    void cellChanged(int row, int column);
 
 private:
     struct ColorEntry {
         QString key;
         QString hex;
+        qreal weight = 1.0;
+    };
+
+    struct BoardSnapshot {
+        GridBoard board;
+        GridSpawnStream spawns;
+        GridMatchTracker matchTracker;
+        GridMoveIndex moveIndex;
     };
 
     QVector<ColorEntry> m_palette;
-    QVector<ColorEntry> m_spawnPool;
+    QStringList m_paletteKeys;
+    GridSpawnStream m_spawnStream;
+    GridBoard m_board;
+    GridBoard m_scratch;
+    QList<GridSpawn> m_spawnBuffer;
+    QList<GridMove> m_moveBuffer;
+    QList<GridMatch> m_matchBuffer;
+    QList<GridCascadeEvent> m_timelineBuffer;
+    QList<GridSwap> m_swapBuffer;
+    QList<GridMatchShape> m_shapeBuffer;
+    mutable GridMatchKernel m_matchKernel;
+    GridMatchTracker m_matchTracker;
+    GridMoveIndex m_moveIndex;
+    GridMatchShapes m_matchShapes;
     int m_rowCount = 6;
     int m_columnCount = 6;
     int m_fillDirection = 1;
     quint32 m_seed = 1u;
-    int m_poolIndex = 0;
+    bool m_verifyMatches = false;
+    bool m_largeBoard = false;
+    QSharedPointer<GridTurnSearch> m_search;
+    // Every search whose result has not come back yet, m_search included;
+    // their workers post to this object until they are done.
+    QList<QSharedPointer<GridTurnSearch>> m_searches;
+    QHash<int, BoardSnapshot> m_snapshots;
+    int m_nextSnapshotId = 1;
+    QSharedPointer<GridReplayWriter> m_replayWriter;
+    int m_replayGrid = 0;
 
-    void rebuildPool();
+    void applySpawnWeights();
+    void finishPlanning(const GridTurnSearch *search, const GridTurnPlan &plan);
+    QList<int> packedCells() const;
+    void record(int kind, const QVector<quint64> &values = QVector<quint64>());
+    void recordArguments(int kind, const QList<int> &arguments);
+    void recordState(int kind);
 
-    QVector<QVector<QString>> toMatrix(const QVariantList &matrixVariant) const;
-    QVariantList prepareFillInternal(QVector<QVector<QString>> &matrix);
-    QVariantList compactionMovesInternal(QVector<QVector<QString>> &matrix) const;
-    QVariantList detectMatchesInternal(const QVector<QVector<QString>> &matrix) const;
-    ColorEntry chooseFromPool(QVector<QVector<QString>> &matrix, int row, int column);
-    bool wouldCreateMatch(const QVector<QVector<QString>> &matrix, int row, int column, const QString &colorKey) const;
+    GridBoard toBoard(const QVariantList &matrixVariant) const;
+    bool setCell(int row, int column, quint8 value);
+    void touchCell(int row, int column);
+    QVariantMap spawnSpec(quint8 color) const;
+    void planRowSpawns(GridBoard &board, int row, QList<GridSpawn> &spawns);
+    void prepareFillInternal(GridBoard &board, QList<GridSpawn> &spawns);
+    void detectMatchesInternal(const GridBoard &board, QList<GridMatch> &matches) const;
+    int countMatches(const GridBoard &board) const;
+    quint8 chooseSpawn(const GridBoard &board, int row, int column);
 };
 
 #endif // GAMEGRIDORCHESTRATOR_H
@@ -0,0 +1,32 @@
+#include "gamepropertycache.h"
+
+#include <QObject>
+
+GamePropertyHandle GamePropertyCache::writable(const QObject* object, const QString& name)
+{
+    if (!object)
+        return GamePropertyHandle();
+
+    // QML installs its own metaobject once the component's properties exist
+    const QMetaObject* metaObject = object->metaObject();
+    if (metaObject != m_metaObject) {
+        m_metaObject = metaObject;
+        m_handles.clear();
+    }
+
+    const auto cached = m_handles.constFind(name);
+    if (cached != m_handles.constEnd())
+        return *cached;
+
+    GamePropertyHandle handle;
+    const int index = metaObject->indexOfProperty(name.toUtf8().constData());
+    if (index >= 0) {
+        const QMetaProperty property = metaObject->property(index);
+        if (property.isWritable()) {
+            handle.property = property;
+            handle.typeId = property.typeId();
+        }
+    }
+    m_handles.insert(name, handle);
+    return handle;
+}
@@ -0,0 +1,36 @@
+#ifndef GAMEPROPERTYCACHE_H
+#define GAMEPROPERTYCACHE_H
+
+#include <QHash>
+#include <QMetaProperty>
+#include <QMetaType>
+#include <QString>
+
+class QObject;
+
+// A writable property resolved once, with its type id.
+struct GamePropertyHandle
+{
+    QMetaProperty property;
+    int typeId = QMetaType::UnknownType;
+
+    bool isValid() const { return property.isValid(); }
+};
+
+// Writable properties of one object, resolved by name on first use. Each
+// object keeps its own cache: QML instances that declare properties get a
+// metaobject of their own, so handles are only valid while that object
+// lives. Lookups after the first skip the UTF-8 conversion and the linear
+// indexOfProperty() scan; misses are cached too. GUI thread only.
+class GamePropertyCache
+{
+public:
+    // An invalid handle when object has no writable property of that name.
+    GamePropertyHandle writable(const QObject* object, const QString& name);
+
+private:
+    const QMetaObject* m_metaObject = nullptr;
+    QHash<QString, GamePropertyHandle> m_handles;
+};
+
+#endif // GAMEPROPERTYCACHE_H
@@ -0,0 +1,171 @@
+#include "gamereplay.h"
+#include "gamegridorchestrator.h"
+#include <QElapsedTimer>
+#include <QQmlEngine>
+#include <QtAlgorithms>
+
+GameReplay::GameReplay(QObject *parent)
+    : QObject(parent)
+{
+}
+
+GameReplay::~GameReplay()
+{
+    stopRecording();
+    clearPlayback();
+}
+
+int GameReplay::recordedBytes() const
+{
+    return m_writer ? m_writer->data().size() : 0;
+}
+
+void GameReplay::startRecording(const QVariantList &grids)
+{
+    stopRecording();
+    m_writer = QSharedPointer<GridReplayWriter>::create();
+    for (int i = 0; i < grids.size(); ++i) {
+        auto *grid = qobject_cast<GameGridOrchestrator *>(grids.at(i).value<QObject *>());
+        m_recorded.append(grid);
+        if (grid)
+            grid->setReplayWriter(m_writer, i);
+    }
+    m_recording = true;
+    emit recordingChanged();
+}
+
+void GameReplay::stopRecording()
+{
+    if (!m_recording)
+        return;
+    for (const QPointer<GameGridOrchestrator> &grid : std::as_const(m_recorded)) {
+        if (grid)
+            grid->setReplayWriter(QSharedPointer<GridReplayWriter>(), 0);
+    }
+    m_recorded.clear();
+    m_recording = false;
+    // The stream stays available to save() until the next recording.
+    emit recordingChanged();
+}
+
+void GameReplay::recordTurnEnd(QObject *grid)
+{
+    auto *orchestrator = qobject_cast<GameGridOrchestrator *>(grid);
+    if (orchestrator && m_recorded.contains(orchestrator))
+        orchestrator->recordTurnEnd();
+}
+
+void GameReplay::recordPowerup(QObject *grid, int slot)
+{
+    auto *orchestrator = qobject_cast<GameGridOrchestrator *>(grid);
+    if (orchestrator && m_recorded.contains(orchestrator))
+        orchestrator->recordPowerup(slot);
+}
+
+bool GameReplay::save(const QString &path) const
+{
+    return m_writer && m_writer->save(path);
+}
+
+bool GameReplay::open(const QString &path)
+{
+    clearPlayback();
+    return m_reader.open(path);
+}
+
+QVariantMap GameReplay::fastForward()
+{
+    QElapsedTimer clock;
+    clock.start();
+    int events = 0;
+    GridReplayEvent event;
+    while (m_reader.next(event)) {
+        if (!playEvent(event))
+            break;
+        ++events;
+    }
+
+    int turns = 0;
+    for (const int count : std::as_const(m_turns))
+        turns += count;
+    QVariantList hashes;
+    for (const GameGridOrchestrator *grid : std::as_const(m_playback))
+        hashes.append(grid ? grid->boardHashText() : QString());
+
+    QVariantMap result;
+    result.insert(QStringLiteral("events"), events);
+    result.insert(QStringLiteral("turns"), turns);
+    result.insert(QStringLiteral("elapsedMs"), clock.elapsed());
+    result.insert(QStringLiteral("hashes"), hashes);
+    result.insert(QStringLiteral("desyncs"), m_desyncs);
+    result.insert(QStringLiteral("error"), m_reader.hasError() || !m_reader.atEnd());
+    return result;
+}
+
+QVariantMap GameReplay::nextEvent()
+{
+    GridReplayEvent event;
+    if (!m_reader.next(event) || !playEvent(event))
+        return QVariantMap();
+
+    QList<int> values;
+    values.reserve(event.values.size());
+    for (const quint64 value : std::as_const(event.values))
+        values.append(int(value));
+    QVariantMap map;
+    map.insert(QStringLiteral("kind"), event.kind);
+    map.insert(QStringLiteral("grid"), event.grid);
+    map.insert(QStringLiteral("values"), QVariant::fromValue(values));
+    return map;
+}
+
+QObject *GameReplay::playbackGrid(int grid) const
+{
+    return grid >= 0 && grid < m_playback.size() ? m_playback.at(grid) : nullptr;
+}
+
+bool GameReplay::playEvent(const GridReplayEvent &event)
+{
+    // Grids are declared in order before their first use.
+    if (event.kind == GridReplayEvent::Grid && event.grid == m_playback.size()) {
+        // Owned here: playbackGrid() hands them to QML, which must not
+        // garbage-collect them.
+        auto *grid = new GameGridOrchestrator;
+        grid->setParent(this);
+        QQmlEngine::setObjectOwnership(grid, QQmlEngine::CppOwnership);
+        m_playback.append(grid);
+        m_turns.append(0);
+    }
+    if (event.grid < 0 || event.grid >= m_playback.size())
+        return false;
+
+    GameGridOrchestrator *grid = m_playback.at(event.grid);
+    if (!grid->replayEvent(event))
+        return false;
+
+    if (event.kind == GridReplayEvent::TurnEnd && !event.values.isEmpty()) {
+        const int turn = ++m_turns[event.grid];
+        if (event.values.first() != grid->boardHash()) {
+            QVariantMap desync;
+            desync.insert(QStringLiteral("grid"), event.grid);
+            desync.insert(QStringLiteral("turn"), turn);
+            desync.insert(QStringLiteral("expected"),
+                          QStringLiteral("%1").arg(event.values.first(), 16, 16, QLatin1Char('0')));
+            desync.insert(QStringLiteral("actual"), grid->boardHashText());
+            m_desyncs.append(desync);
+            emit desyncDetected(event.grid, turn);
+        }
+    } else if (event.kind == GridReplayEvent::Powerup && !event.values.isEmpty()) {
+        emit powerupReplayed(event.grid, int(GridReplayEvent::unzigzag(event.values.first())));
+    }
+    return true;
+}
+
+void GameReplay::clearPlayback()
+{
+    qDeleteAll(m_playback);
+    m_playback.clear();
+    m_turns.clear();
+    m_desyncs.clear();
+    m_reader.close();
+}
@@ -0,0 +1,78 @@
+#ifndef GAMEREPLAY_H
+#define GAMEREPLAY_H
+
+#include "gridreplay.h"
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QVariantList>
+#include <QVariantMap>
+
+class GameGridOrchestrator;
+
+// Records a match as a compact replay stream and plays one back. While
+// recording, the attached orchestrators append every board-changing call
+// themselves (see GameGridOrchestrator::setReplayWriter); turn ends add
+// the board hash so playback can pinpoint the first turn that diverges.
+// Playback maps the file and re-drives orchestrators of its own, either
+// all at once (fastForward) or one record at a time (nextEvent) for a
+// view that animates them.
+class GameReplay : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+
+public:
+    explicit GameReplay(QObject *parent = nullptr);
+    ~GameReplay() override;
+
+    bool isRecording() const { return m_recording; }
+    // Size of the stream recorded so far.
+    Q_INVOKABLE int recordedBytes() const;
+
+    // grids holds GameGridOrchestrator objects; their list index is the
+    // grid number in the stream. Restarting discards the previous stream.
+    Q_INVOKABLE void startRecording(const QVariantList &grids);
+    Q_INVOKABLE void stopRecording();
+    Q_INVOKABLE void recordTurnEnd(QObject *grid);
+    Q_INVOKABLE void recordPowerup(QObject *grid, int slot);
+    // Saves the stream recorded so far; recording continues.
+    Q_INVOKABLE bool save(const QString &path) const;
+
+    // Maps a recording for playback and creates its grids on the first
+    // records. Returns false when the file is missing or not a replay.
+    Q_INVOKABLE bool open(const QString &path);
+    // Plays every remaining record without animation. Returns { events,
+    // turns, elapsedMs, hashes, desyncs, error }: hashes holds each
+    // grid's final board hash and desyncs one { grid, turn, expected,
+    // actual } map per TurnEnd whose hash did not match.
+    Q_INVOKABLE QVariantMap fastForward();
+    // Plays the next record and returns it as { kind, grid, values }, kind
+    // being a GridReplayEvent::Kind, or an empty map at the end.
+    Q_INVOKABLE QVariantMap nextEvent();
+    // Grid orchestrators created by playback, in stream order.
+    Q_INVOKABLE QObject *playbackGrid(int grid) const;
+
+    const QSharedPointer<GridReplayWriter> &writer() const { return m_writer; }
+    const QList<GameGridOrchestrator *> &playbackGrids() const { return m_playback; }
+
+signals:
+    void recordingChanged();
+    void powerupReplayed(int grid, int slot);
+    void desyncDetected(int grid, int turn);
+
+private:
+    bool playEvent(const GridReplayEvent &event);
+    void clearPlayback();
+
+    QSharedPointer<GridReplayWriter> m_writer;
+    QList<QPointer<GameGridOrchestrator>> m_recorded;
+    bool m_recording = false;
+    GridReplayReader m_reader;
+    QList<GameGridOrchestrator *> m_playback;
+    QList<int> m_turns;
+    QVariantList m_desyncs;
+};
+
+#endif // GAMEREPLAY_H
@@ -1,5 +1,6 @@
 #include "gamespritesheetelement.h"
 #include "abstractgameelement.h"
+#include "gameeasing.h"
 #include <QQuickWindow>
 #include <QQmlEngine>
 #include <QQmlFile>
@@ -150,44 +151,6 @@ QRectF GameSpriteSheetElement::frameRectPx(int frameIndex) const
     return QRectF(sx, sy, m_frameWidth, m_frameHeight);
 }
 
-QEasingCurve GameSpriteSheetElement::easingFromQJSValue(const QJSValue& v) const
-{
-    // Accept:
-    //  - number (QEasingCurve::Type)
-    //  - { easing: Easing.Linear } or { type: "InOutQuad" }
-    //  - "linear", "inoutquad", "Easing.OutCubic"
-    if (v.isNumber())
-        return QEasingCurve(static_cast<QEasingCurve::Type>(v.toInt()));
-
-    if (v.isObject()) {
-        QJSValue ev = v.property("easing");
-        if (!ev.isUndefined())
-            return easingFromQJSValue(ev);
-        QJSValue tv = v.property("type");
-        if (!tv.isUndefined())
-            return easingFromQJSValue(tv);
-    }
-
-    QString name = v.toString().trimmed();
-    if (name.startsWith(u"Easing.", Qt::CaseInsensitive))
-        name = name.mid(7);
-    name = name.toLower();
-
-    static const QHash<QString, QEasingCurve::Type> map = {
-                                                           {"linear", QEasingCurve::Linear},
-                                                           {"inquad", QEasingCurve::InQuad}, {"outquad", QEasingCurve::OutQuad}, {"inoutquad", QEasingCurve::InOutQuad},
-                                                           {"incubic", QEasingCurve::InCubic}, {"outcubic", QEasingCurve::OutCubic}, {"inoutcubic", QEasingCurve::InOutCubic},
-                                                           {"inquart", QEasingCurve::InQuart}, {"outquart", QEasingCurve::OutQuart}, {"inoutquart", QEasingCurve::InOutQuart},
-                                                           {"inquint", QEasingCurve::InQuint}, {"outquint", QEasingCurve::OutQuint}, {"inoutquint", QEasingCurve::InOutQuint},
-                                                           {"insine", QEasingCurve::InSine}, {"outsine", QEasingCurve::OutSine}, {"inoutsine", QEasingCurve::InOutSine},
-                                                           {"inexpo", QEasingCurve::InExpo}, {"outexpo", QEasingCurve::OutExpo}, {"inoutexpo", QEasingCurve::InOutExpo},
-                                                           {"inelastic", QEasingCurve::InElastic}, {"outelastic", QEasingCurve::OutElastic}, {"inoutelastic", QEasingCurve::InOutElastic},
-                                                           {"inback", QEasingCurve::InBack}, {"outback", QEasingCurve::OutBack}, {"inoutback", QEasingCurve::InOutBack},
-                                                           {"inbounce", QEasingCurve::InBounce}, {"outbounce", QEasingCurve::OutBounce}, {"inoutbounce", QEasingCurve::InOutBounce},
-                                                           };
-    return QEasingCurve(map.value(name, QEasingCurve::InOutQuad));
-}
-
 bool GameSpriteSheetElement::interpolate(int startFrame, int endFrame, int durationMs,
                                          QJSValue easing, QJSValue start_func, QJSValue end_func)
 {
@@ -204,7 +167,7 @@ bool GameSpriteSheetElement::interpolate(int startFrame, int endFrame, int durat
 
     // Call start callback
     if (start_func.isCallable()) {
-        QJSValueList args; args << qmlEngine(this)->newQObject(this);
+        QJSValueList args; args << jsWrapper();
         start_func.call(args);
     }
 
@@ -212,11 +175,11 @@ bool GameSpriteSheetElement::interpolate(int startFrame, int endFrame, int durat
     m_frameAnim->setStartValue(startFrame);
     m_frameAnim->setEndValue(endFrame);
     m_frameAnim->setDuration(qMax(0, durationMs));
-    m_frameAnim->setEasingCurve(easingFromQJSValue(easing));
+    m_frameAnim->setEasingCurve(GameEasing::fromJSValue(easing));
 
     connect(m_frameAnim, &QPropertyAnimation::finished, this, [this, end_func]() mutable {
         if (end_func.isCallable()) {
-            QJSValueList args; args << qmlEngine(this)->newQObject(this);
+            QJSValueList args; args << jsWrapper();
             end_func.call(args);
         }
         m_frameAnim->deleteLater();
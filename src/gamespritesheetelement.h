@@ -72,7 +72,6 @@ private:
     void ensureTexture();
     void recomputeGrid();     // columns/rows/count from image & frame size
     QRectF frameRectPx(int frameIndex) const;
-    QEasingCurve easingFromQJSValue(const QJSValue& v) const; // local (kept independent of base)
 
 private:
     QUrl  m_source;
@@ -0,0 +1,357 @@
+#include "gametweenengine.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QLineF>
+#include <QQuaternion>
+#include <QRectF>
+#include <QVector2D>
+#include <QVector3D>
+#include <QVector4D>
+
+namespace {
+bool isNumericType(int typeId)
+{
+    switch (typeId) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isInterpolatedType(int typeId)
+{
+    switch (typeId) {
+    case QMetaType::QPoint:
+    case QMetaType::QPointF:
+    case QMetaType::QSize:
+    case QMetaType::QSizeF:
+    case QMetaType::QRect:
+    case QMetaType::QRectF:
+    case QMetaType::QLine:
+    case QMetaType::QLineF:
+    case QMetaType::QColor:
+    case QMetaType::QVector2D:
+    case QMetaType::QVector3D:
+    case QMetaType::QVector4D:
+    case QMetaType::QQuaternion:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template<typename T>
+T lerp(const T& from, const T& to, qreal progress)
+{
+    return from + (to - from) * progress;
+}
+
+int lerpInt(int from, int to, qreal progress)
+{
+    return from + qRound((to - from) * progress);
+}
+
+// Same arithmetic as QVariantAnimation's interpolators.
+QVariant interpolate(int typeId, const QVariant& from, const QVariant& to, qreal progress)
+{
+    switch (typeId) {
+    case QMetaType::QPoint:
+        return lerp(from.toPoint(), to.toPoint(), progress);
+    case QMetaType::QPointF:
+        return lerp(from.toPointF(), to.toPointF(), progress);
+    case QMetaType::QSize:
+        return lerp(from.toSize(), to.toSize(), progress);
+    case QMetaType::QSizeF:
+        return lerp(from.toSizeF(), to.toSizeF(), progress);
+    case QMetaType::QRect: {
+        const QRect a = from.toRect();
+        const QRect b = to.toRect();
+        QRect rect;
+        rect.setCoords(lerpInt(a.left(), b.left(), progress), lerpInt(a.top(), b.top(), progress),
+                       lerpInt(a.right(), b.right(), progress), lerpInt(a.bottom(), b.bottom(), progress));
+        return rect;
+    }
+    case QMetaType::QRectF: {
+        const QRectF a = from.toRectF();
+        const QRectF b = to.toRectF();
+        return QRectF(lerp(a.topLeft(), b.topLeft(), progress), lerp(a.size(), b.size(), progress));
+    }
+    case QMetaType::QLine: {
+        const QLine a = from.toLine();
+        const QLine b = to.toLine();
+        return QLine(lerp(a.p1(), b.p1(), progress), lerp(a.p2(), b.p2(), progress));
+    }
+    case QMetaType::QLineF: {
+        const QLineF a = from.toLineF();
+        const QLineF b = to.toLineF();
+        return QLineF(lerp(a.p1(), b.p1(), progress), lerp(a.p2(), b.p2(), progress));
+    }
+    case QMetaType::QColor: {
+        const QColor a = from.value<QColor>();
+        const QColor b = to.value<QColor>();
+        return QColor(lerpInt(a.red(), b.red(), progress), lerpInt(a.green(), b.green(), progress),
+                      lerpInt(a.blue(), b.blue(), progress), lerpInt(a.alpha(), b.alpha(), progress));
+    }
+    case QMetaType::QVector2D:
+        return lerp(from.value<QVector2D>(), to.value<QVector2D>(), float(progress));
+    case QMetaType::QVector3D:
+        return lerp(from.value<QVector3D>(), to.value<QVector3D>(), float(progress));
+    case QMetaType::QVector4D:
+        return lerp(from.value<QVector4D>(), to.value<QVector4D>(), float(progress));
+    case QMetaType::QQuaternion:
+        return QQuaternion::slerp(from.value<QQuaternion>(), to.value<QQuaternion>(), float(progress));
+    default:
+        return progress < 1.0 ? from : to;
+    }
+}
+
+// value converted to typeId, or an invalid QVariant when it does not convert.
+QVariant convertedTo(int typeId, QVariant value)
+{
+    if (value.typeId() != typeId && !value.convert(QMetaType(typeId)))
+        return QVariant();
+    return value;
+}
+}
+
+class GameTweenEngine::Driver : public QAbstractAnimation
+{
+public:
+    explicit Driver(GameTweenEngine* engine)
+        : QAbstractAnimation(engine)
+        , m_engine(engine)
+    {
+    }
+
+    int duration() const override { return -1; }
+
+protected:
+    void updateCurrentTime(int currentTime) override { m_engine->tick(currentTime); }
+
+private:
+    GameTweenEngine* m_engine;
+};
+
+GameTweenEngine::GameTweenEngine(QObject* parent)
+    : QObject(parent)
+    , m_driver(new Driver(this))
+{
+}
+
+GameTweenEngine* GameTweenEngine::instance()
+{
+    static QPointer<GameTweenEngine> engine;
+    if (!engine)
+        engine = new GameTweenEngine(QCoreApplication::instance());
+    return engine;
+}
+
+int GameTweenEngine::start(QObject* target, const QVector<GameTweenChannel>& channels, int durationMs,
+                           QEasingCurve::Type easing, Finished finished)
+{
+    if (!target || channels.isEmpty())
+        return 0;
+
+    const bool running = m_driver->state() == QAbstractAnimation::Running;
+    const int now = running ? m_driver->currentTime() : 0;
+    const int tween = m_nextTween++;
+    if (m_nextTween <= 0)
+        m_nextTween = 1;
+
+    Tween entry;
+    entry.finished = std::move(finished);
+    for (const GameTweenChannel& channel : channels) {
+        const int typeId = channel.property.typeId();
+        const bool numeric = isNumericType(typeId);
+        // Both ends in the property's own type, or the channel only sets its end.
+        QVariant fromValue;
+        QVariant endValue = channel.to;
+        if (!numeric && isInterpolatedType(typeId)) {
+            const QVariant to = convertedTo(typeId, channel.to);
+            fromValue = convertedTo(typeId, channel.from);
+            if (to.isValid() && fromValue.isValid())
+                endValue = to;
+            else
+                fromValue = QVariant();
+        }
+        const int delay = qMax(0, channel.delayMs);
+        const int duration = qMax(0, channel.durationMs < 0 ? durationMs : channel.durationMs);
+        // The segment that starts where this one ends writes the boundary
+        // value; if this one wrote too, a late frame could leave it behind.
+        bool handoff = false;
+        for (const GameTweenChannel& next : channels) {
+            if (&next != &channel && next.property.propertyIndex() == channel.property.propertyIndex()
+                && qMax(0, next.delayMs) == delay + duration && !(duration == 0 && &next < &channel)) {
+                handoff = true;
+                break;
+            }
+        }
+        m_targets.append(target);
+        m_properties.append(channel.property);
+        m_from.append(numeric ? channel.from.toDouble() : 0.0);
+        m_to.append(numeric ? channel.to.toDouble() : 0.0);
+        m_fromValues.append(fromValue);
+        m_endValues.append(numeric ? QVariant() : endValue);
+        m_starts.append(now + delay);
+        m_durations.append(duration);
+        m_easings.append(quint8(channel.easing < 0 ? easing : channel.easing));
+        m_handoffs.append(handoff);
+        m_owners.append(tween);
+        ++entry.channels;
+    }
+    m_tweens.insert(tween, entry);
+
+    if (!running)
+        m_driver->start();
+    return tween;
+}
+
+void GameTweenEngine::cancel(int tween)
+{
+    if (!m_tweens.remove(tween))
+        return;
+    // A property write inside tick() got here; tick() drops the channels.
+    if (m_ticking)
+        return;
+    for (int i = m_owners.size() - 1; i >= 0; --i) {
+        if (m_owners.at(i) == tween)
+            removeChannel(i);
+    }
+    if (m_targets.isEmpty())
+        m_driver->stop();
+}
+
+void GameTweenEngine::tick(int nowMs)
+{
+    QVector<Finished> completed;
+    m_ticking = true;
+    int i = 0;
+    while (i < m_targets.size()) {
+        QObject* target = m_targets.at(i);
+        const int owner = m_owners.at(i);
+        if (!m_tweens.contains(owner)) {
+            // Cancelled while this tick was writing properties.
+            removeChannel(i);
+            continue;
+        }
+        if (!target) {
+            // The target is gone; its tween ends without a callback.
+            Tween& tween = m_tweens[owner];
+            tween.finished = nullptr;
+            if (--tween.channels == 0)
+                m_tweens.remove(owner);
+            removeChannel(i);
+            continue;
+        }
+
+        if (nowMs < m_starts.at(i)) {
+            // A later keyframe segment; the property belongs to an earlier one.
+            ++i;
+            continue;
+        }
+
+        const int duration = m_durations.at(i);
+        const qreal progress = duration > 0 ? qBound<qreal>(0.0, qreal(nowMs - m_starts.at(i)) / duration, 1.0) : 1.0;
+        // Copies: a write can start tweens and grow the arrays under us.
+        const QMetaProperty property = m_properties.at(i);
+        const QVariant endValue = m_endValues.at(i);
+        const QVariant fromValue = m_fromValues.at(i);
+        if (progress >= 1.0 && m_handoffs.at(i)) {
+            // The next segment has started and writes this value itself.
+        } else if (!endValue.isValid()) {
+            const double from = m_from.at(i);
+            const qreal eased = easedProgress(QEasingCurve::Type(m_easings.at(i)), progress);
+            property.write(target, from + (m_to.at(i) - from) * eased);
+        } else if (fromValue.isValid()) {
+            if (progress >= 1.0) {
+                property.write(target, endValue);
+            } else {
+                const qreal eased = easedProgress(QEasingCurve::Type(m_easings.at(i)), progress);
+                property.write(target, interpolate(property.typeId(), fromValue, endValue, eased));
+            }
+        } else if (progress >= 1.0) {
+            property.write(target, endValue);
+        }
+
+        if (progress < 1.0) {
+            ++i;
+            continue;
+        }
+
+        // The write may have cancelled the tween; cancel() left the channel.
+        if (m_tweens.contains(owner)) {
+            Tween& tween = m_tweens[owner];
+            if (--tween.channels == 0) {
+                if (tween.finished)
+                    completed.append(std::move(tween.finished));
+                m_tweens.remove(owner);
+            }
+        }
+        removeChannel(i);
+    }
+    m_ticking = false;
+
+    if (m_targets.isEmpty())
+        m_driver->stop();
+
+    // Callbacks may start or cancel tweens, so they run last.
+    for (const Finished& finished : std::as_const(completed))
+        finished();
+}
+
+void GameTweenEngine::removeChannel(int index)
+{
+    // Order does not matter, so the last channel fills the hole.
+    const int last = m_targets.size() - 1;
+    if (index != last) {
+        m_targets[index] = m_targets.at(last);
+        m_properties[index] = m_properties.at(last);
+        m_from[index] = m_from.at(last);
+        m_to[index] = m_to.at(last);
+        m_fromValues[index] = m_fromValues.at(last);
+        m_endValues[index] = m_endValues.at(last);
+        m_starts[index] = m_starts.at(last);
+        m_durations[index] = m_durations.at(last);
+        m_easings[index] = m_easings.at(last);
+        m_handoffs[index] = m_handoffs.at(last);
+        m_owners[index] = m_owners.at(last);
+    }
+    m_targets.removeLast();
+    m_properties.removeLast();
+    m_from.removeLast();
+    m_to.removeLast();
+    m_fromValues.removeLast();
+    m_endValues.removeLast();
+    m_starts.removeLast();
+    m_durations.removeLast();
+    m_easings.removeLast();
+    m_handoffs.removeLast();
+    m_owners.removeLast();
+}
+
+qreal GameTweenEngine::easedProgress(QEasingCurve::Type type, qreal progress)
+{
+    if (type == QEasingCurve::Linear)
+        return progress;
+    if (m_curves.isEmpty()) {
+        m_curves.reserve(QEasingCurve::NCurveTypes);
+        for (int curve = 0; curve < QEasingCurve::NCurveTypes; ++curve) {
+            // Spline and custom curves need data a bare type does not carry.
+            const bool shaped = curve == QEasingCurve::BezierSpline || curve == QEasingCurve::TCBSpline
+                || curve == QEasingCurve::Custom;
+            m_curves.append(QEasingCurve(shaped ? QEasingCurve::Linear : QEasingCurve::Type(curve)));
+        }
+    }
+    return m_curves.at(qBound(0, int(type), int(m_curves.size()) - 1)).valueForProgress(progress);
+}
@@ -0,0 +1,93 @@
+#ifndef GAMETWEENENGINE_H
+#define GAMETWEENENGINE_H
+
+#include <QAbstractAnimation>
+#include <QEasingCurve>
+#include <QHash>
+#include <QMetaProperty>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+#include <functional>
+
+// One property of a tween: a resolved property handle and the values it
+// runs between. Numbers and the types QVariantAnimation interpolates
+// (QPoint(F), QSize(F), QRect(F), QLine(F), QColor, QVector2D/3D/4D and
+// QQuaternion) are interpolated; other types, and values that do not
+// convert to the property's type, are written once, with their end value,
+// when the channel finishes. A channel may
+// cover only part of its tween (one keyframe segment): it waits delayMs
+// after the tween starts and then runs for its own duration and easing.
+struct GameTweenChannel
+{
+    QMetaProperty property;
+    QVariant from;
+    QVariant to;
+    int delayMs = 0;
+    int durationMs = -1; // < 0: the tween's duration
+    int easing = -1;     // < 0: the tween's easing
+};
+
+// Scene-wide tween driver. Every running tween channel lives in one set of
+// parallel arrays (target, property handle, from, to, start time, duration,
+// easing, owning tween); a single animation-timer tick advances them all
+// and writes through the stored handles, so a board full of falling blocks
+// costs one timer callback per frame instead of one animation object per
+// property. Lives on the GUI thread.
+class GameTweenEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Finished = std::function<void()>;
+
+    static GameTweenEngine* instance();
+
+    // Starts a tween of target and returns its id (> 0), or 0 when there
+    // is nothing to animate. finished runs once every channel has reached
+    // its end value, unless the tween was cancelled or target destroyed.
+    // Segments of one property should not overlap in time.
+    int start(QObject* target, const QVector<GameTweenChannel>& channels, int durationMs,
+              QEasingCurve::Type easing, Finished finished);
+    // Stops a tween where it is, without running its finished callback.
+    void cancel(int tween);
+    bool isRunning(int tween) const { return m_tweens.contains(tween); }
+    int runningChannelCount() const { return m_targets.size(); }
+
+private:
+    class Driver;
+
+    struct Tween
+    {
+        int channels = 0;
+        Finished finished;
+    };
+
+    explicit GameTweenEngine(QObject* parent = nullptr);
+
+    void tick(int nowMs);
+    void removeChannel(int index);
+    qreal easedProgress(QEasingCurve::Type type, qreal progress);
+
+    Driver* m_driver = nullptr;
+    bool m_ticking = false;
+    int m_nextTween = 1;
+    QHash<int, Tween> m_tweens;
+    QVector<QEasingCurve> m_curves;
+
+    // One entry per running channel.
+    QVector<QPointer<QObject>> m_targets;
+    QVector<QMetaProperty> m_properties;
+    QVector<double> m_from;
+    QVector<double> m_to;
+    QVector<QVariant> m_fromValues; // only for interpolated non-numeric channels
+    QVector<QVariant> m_endValues;  // only for non-numeric channels
+    QVector<int> m_starts;
+    QVector<int> m_durations;
+    QVector<quint8> m_easings;
+    QVector<bool> m_handoffs; // a later segment of the same property takes over at the end
+    QVector<int> m_owners;
+};
+
+#endif // GAMETWEENENGINE_H
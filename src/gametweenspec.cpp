@@ -0,0 +1,10 @@
+#include "gametweenspec.h"
+
+const QString& TweenSpec::fieldName(Field field)
+{
+    static const QString names[FieldCount] = {
+        QStringLiteral("x"), QStringLiteral("y"), QStringLiteral("opacity"),
+        QStringLiteral("scale"), QStringLiteral("rotation"),
+    };
+    return names[qBound(0, int(field), int(FieldCount) - 1)];
+}
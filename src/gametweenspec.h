@@ -0,0 +1,75 @@
+#ifndef GAMETWEENSPEC_H
+#define GAMETWEENSPEC_H
+
+#include <QEasingCurve>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+
+// Targets for a tween of the common item properties, plus an easing that
+// is already resolved. Only the fields that were written take part, so one
+// spec can move x and y while another also fades opacity. QML builds a spec
+// once with AbstractGameElement::tweenSpec(), keeps it in a property and
+// updates the targets on a copy before each tweenTo().
+class TweenSpec
+{
+    Q_GADGET
+    Q_PROPERTY(qreal x READ x WRITE setX RESET resetX)
+    Q_PROPERTY(qreal y READ y WRITE setY RESET resetY)
+    Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity RESET resetOpacity)
+    Q_PROPERTY(qreal scale READ scale WRITE setScale RESET resetScale)
+    Q_PROPERTY(qreal rotation READ rotation WRITE setRotation RESET resetRotation)
+    Q_PROPERTY(int easing READ easing WRITE setEasing)
+
+public:
+    enum Field {
+        X = 0,
+        Y,
+        Opacity,
+        Scale,
+        Rotation,
+        FieldCount
+    };
+
+    qreal x() const { return m_values[X]; }
+    void setX(qreal value) { set(X, value); }
+    void resetX() { reset(X); }
+    qreal y() const { return m_values[Y]; }
+    void setY(qreal value) { set(Y, value); }
+    void resetY() { reset(Y); }
+    qreal opacity() const { return m_values[Opacity]; }
+    void setOpacity(qreal value) { set(Opacity, value); }
+    void resetOpacity() { reset(Opacity); }
+    qreal scale() const { return m_values[Scale]; }
+    void setScale(qreal value) { set(Scale, value); }
+    void resetScale() { reset(Scale); }
+    qreal rotation() const { return m_values[Rotation]; }
+    void setRotation(qreal value) { set(Rotation, value); }
+    void resetRotation() { reset(Rotation); }
+
+    int easing() const { return m_easing; }
+    void setEasing(int easing) { m_easing = quint8(qBound(0, easing, int(QEasingCurve::NCurveTypes) - 1)); }
+    QEasingCurve::Type easingType() const { return QEasingCurve::Type(m_easing); }
+
+    bool has(Field field) const { return m_fields & (1u << field); }
+    bool isEmpty() const { return m_fields == 0; }
+    qreal value(Field field) const { return m_values[field]; }
+    void set(Field field, qreal value)
+    {
+        m_values[field] = value;
+        m_fields |= quint8(1u << field);
+    }
+    void reset(Field field) { m_fields &= quint8(~(1u << field)); }
+
+    // Property name of a field, as spelled on QQuickItem.
+    static const QString& fieldName(Field field);
+
+private:
+    qreal m_values[FieldCount] = {};
+    quint8 m_fields = 0;
+    quint8 m_easing = QEasingCurve::InOutQuad;
+};
+
+Q_DECLARE_METATYPE(TweenSpec)
+
+#endif // GAMETWEENSPEC_H
@@ -0,0 +1,70 @@
+#include "gridaliastable.h"
+
+#include <algorithm>
+
+GridAliasTable::GridAliasTable(const QVector<quint32> &weights)
+    : m_weights(weights)
+{
+    const int count = qMin(m_weights.size(), 255);
+    m_weights.resize(count);
+    m_starts.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_weights[i] = qMin(m_weights.at(i), MaxWeight);
+        m_starts[i] = m_totalWeight;
+        m_totalWeight += m_weights.at(i);
+        if (m_weights.at(i) != m_weights.at(0))
+            m_uniform = false;
+    }
+    if (m_uniform || m_totalWeight == 0)
+        return;
+
+    // Every column holds totalWeight units. Scaled by the column count, an
+    // entry's weight is measured in those units; a light entry keeps its
+    // own share of a column and lends the rest to a heavy one.
+    QVector<quint64> scaled(count);
+    QVector<int> light;
+    QVector<int> heavy;
+    for (int i = 0; i < count; ++i) {
+        scaled[i] = quint64(m_weights.at(i)) * quint64(count);
+        (scaled.at(i) < m_totalWeight ? light : heavy).append(i);
+    }
+
+    m_thresholds.fill(m_totalWeight, count);
+    m_aliases.resize(count);
+    for (int i = 0; i < count; ++i)
+        m_aliases[i] = static_cast<quint8>(i);
+    while (!light.isEmpty() && !heavy.isEmpty()) {
+        const int small = light.takeLast();
+        const int large = heavy.last();
+        m_thresholds[small] = quint32(scaled.at(small));
+        m_aliases[small] = static_cast<quint8>(large);
+        scaled[large] -= m_totalWeight - scaled.at(small);
+        if (scaled.at(large) < m_totalWeight) {
+            heavy.removeLast();
+            light.append(large);
+        }
+    }
+}
+
+quint32 GridAliasTable::range() const
+{
+    if (m_uniform)
+        return quint32(size());
+    return quint32(size()) * m_totalWeight;
+}
+
+int GridAliasTable::sample(quint32 draw) const
+{
+    if (m_uniform)
+        return int(draw);
+    const int column = int(draw / m_totalWeight);
+    return (draw % m_totalWeight) < m_thresholds.at(column) ? column : m_aliases.at(column);
+}
+
+int GridAliasTable::locate(quint32 offset) const
+{
+    // Zero-weight entries share their start with the next entry, so the
+    // last start not above offset is always a weighted one.
+    const auto it = std::upper_bound(m_starts.cbegin(), m_starts.cend(), offset);
+    return int(it - m_starts.cbegin()) - 1;
+}
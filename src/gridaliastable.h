@@ -0,0 +1,43 @@
+#ifndef GRIDALIASTABLE_H
+#define GRIDALIASTABLE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+// Walker/Vose alias table over integer weights. Built once per palette;
+// sample() maps one uniform draw below range() to an index in O(1), and
+// locate() maps an offset into the concatenated weights back to its index
+// for callers that need to sample a subset. All arithmetic is integral, so
+// the same weights give the same draws on every platform.
+class GridAliasTable
+{
+public:
+    // Per-entry cap keeping range() within 32 bits for up to 255 entries.
+    static constexpr quint32 MaxWeight = 0xffff;
+
+    GridAliasTable() = default;
+    explicit GridAliasTable(const QVector<quint32> &weights);
+
+    int size() const { return m_weights.size(); }
+    bool isValid() const { return m_totalWeight > 0; }
+    bool isUniform() const { return m_uniform; }
+
+    quint32 weight(int index) const { return m_weights.at(index); }
+    quint32 totalWeight() const { return m_totalWeight; }
+    // Offset of index's slice in the concatenated weights.
+    quint32 start(int index) const { return m_starts.at(index); }
+
+    quint32 range() const;
+    int sample(quint32 draw) const;
+    int locate(quint32 offset) const;
+
+private:
+    QVector<quint32> m_weights;
+    QVector<quint32> m_starts;
+    QVector<quint32> m_thresholds;
+    QVector<quint8> m_aliases;
+    quint32 m_totalWeight = 0;
+    bool m_uniform = true;
+};
+
+#endif // GRIDALIASTABLE_H
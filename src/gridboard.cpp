@@ -0,0 +1,127 @@
+#include "gridboard.h"
+
+GridBoard::GridBoard(int rows, int columns, const QStringList &palette)
+    : m_rowCount(qMax(0, rows))
+    , m_columnCount(qMax(0, columns))
+    , m_palette(palette.mid(0, MaxColors))
+{
+    // Largest power of two of rows that stays within ChunkCells.
+    const int chunkRows = qMax(1, ChunkCells / qMax(1, m_columnCount));
+    while ((2 << m_chunkShift) <= chunkRows)
+        ++m_chunkShift;
+
+    const int rowsPerChunk = 1 << m_chunkShift;
+    for (int first = 0; first < m_rowCount; first += rowsPerChunk) {
+        const int rows = qMin(rowsPerChunk, m_rowCount - first);
+        m_chunks.append(QVector<quint8>(rows * m_columnCount, EmptyCell));
+    }
+}
+
+void GridBoard::swapCells(int row1, int column1, int row2, int column2)
+{
+    const quint8 value = at(row1, column1);
+    set(row1, column1, at(row2, column2));
+    set(row2, column2, value);
+}
+
+void GridBoard::fill(quint8 value)
+{
+    for (QVector<quint8> &chunk : m_chunks)
+        chunk.fill(value);
+    m_hash = 0;
+    if (value == EmptyCell)
+        return;
+    for (int row = 0; row < m_rowCount; ++row) {
+        for (int column = 0; column < m_columnCount; ++column)
+            m_hash ^= cellKey(row, column, value);
+    }
+}
+
+quint8 GridBoard::colorIndex(const QString &key) const
+{
+    if (key.isEmpty())
+        return EmptyCell;
+    const int index = m_palette.indexOf(key);
+    return index < 0 ? EmptyCell : static_cast<quint8>(index + 1);
+}
+
+quint8 GridBoard::internColor(const QString &key)
+{
+    if (key.isEmpty())
+        return EmptyCell;
+    const quint8 existing = colorIndex(key);
+    if (existing != EmptyCell)
+        return existing;
+    if (m_palette.size() >= MaxColors)
+        return EmptyCell;
+    m_palette.append(key);
+    return static_cast<quint8>(m_palette.size());
+}
+
+QString GridBoard::colorKey(quint8 value) const
+{
+    if (value == EmptyCell || value > m_palette.size())
+        return QString();
+    return m_palette.at(value - 1);
+}
+
+QString GridBoard::colorKeyAt(int row, int column) const
+{
+    if (!contains(row, column))
+        return QString();
+    return colorKey(at(row, column));
+}
+
+int GridBoard::colorIndexAt(int row, int column) const
+{
+    if (!contains(row, column))
+        return -1;
+    return static_cast<int>(at(row, column)) - 1;
+}
+
+QVariantList GridBoard::toMatrix() const
+{
+    return regionMatrix(0, 0, m_rowCount, m_columnCount);
+}
+
+QVariantList GridBoard::regionMatrix(int firstRow, int firstColumn, int rows, int columns) const
+{
+    const int rowBegin = qBound(0, firstRow, m_rowCount);
+    const int rowEnd = qBound(rowBegin, firstRow + rows, m_rowCount);
+    const int columnBegin = qBound(0, firstColumn, m_columnCount);
+    const int columnEnd = qBound(columnBegin, firstColumn + columns, m_columnCount);
+
+    QVariantList matrix;
+    matrix.reserve(rowEnd - rowBegin);
+    for (int row = rowBegin; row < rowEnd; ++row) {
+        QVariantList rowList;
+        rowList.reserve(columnEnd - columnBegin);
+        const quint8 *cells = rowData(row);
+        for (int column = columnBegin; column < columnEnd; ++column)
+            rowList.append(colorKey(cells[column]));
+        matrix.append(QVariant(rowList));
+    }
+    return matrix;
+}
+
+GridBoard GridBoard::fromMatrix(const QVariantList &matrix, int rows, int columns, const QStringList &palette)
+{
+    GridBoard board(rows, columns, palette);
+    const int rowLimit = qMin(matrix.size(), board.m_rowCount);
+    for (int row = 0; row < rowLimit; ++row) {
+        const QVariantList rowList = matrix.at(row).toList();
+        const int columnLimit = qMin(rowList.size(), board.m_columnCount);
+        for (int column = 0; column < columnLimit; ++column)
+            board.set(row, column, board.internColor(rowList.at(column).toString()));
+    }
+    return board;
+}
+
+bool GridBoard::operator==(const GridBoard &other) const
+{
+    return m_hash == other.m_hash
+        && m_rowCount == other.m_rowCount
+        && m_columnCount == other.m_columnCount
+        && m_chunks == other.m_chunks
+        && m_palette == other.m_palette;
+}
@@ -0,0 +1,113 @@
+#ifndef GRIDBOARD_H
+#define GRIDBOARD_H
+
+#include <QMetaType>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+// Row-major board of interned palette indices. A cell value of 0 means the
+// cell is empty; any other value n refers to palette().at(n - 1). Cells are
+// stored in chunks of whole rows, a power of two of them sized to roughly
+// ChunkCells bytes, each implicitly shared: copying a board is cheap and a
+// write only detaches the chunk it lands in. Small boards fit one chunk.
+//
+// The board also keeps a 64-bit Zobrist hash: the XOR of cellKey() over
+// every occupied cell, updated on each write, so equal boards hash equal
+// however they were reached.
+class GridBoard
+{
+    Q_GADGET
+    Q_PROPERTY(int rowCount READ rowCount)
+    Q_PROPERTY(int columnCount READ columnCount)
+    Q_PROPERTY(QStringList palette READ palette)
+
+public:
+    static constexpr quint8 EmptyCell = 0;
+    static constexpr int MaxColors = 255;
+    static constexpr int ChunkCells = 16384;
+
+    GridBoard() = default;
+    GridBoard(int rows, int columns, const QStringList &palette = QStringList());
+
+    int rowCount() const { return m_rowCount; }
+    int columnCount() const { return m_columnCount; }
+    int cellCount() const { return m_rowCount * m_columnCount; }
+    bool isValid() const { return m_rowCount > 0 && m_columnCount > 0; }
+
+    bool contains(int row, int column) const
+    {
+        return row >= 0 && row < m_rowCount && column >= 0 && column < m_columnCount;
+    }
+    int indexOf(int row, int column) const { return row * m_columnCount + column; }
+
+    quint8 at(int row, int column) const { return m_chunks.at(row >> m_chunkShift).at(chunkOffset(row, column)); }
+    quint8 at(int index) const { return at(index / m_columnCount, index % m_columnCount); }
+    void set(int row, int column, quint8 value)
+    {
+        quint8 &cell = m_chunks[row >> m_chunkShift][chunkOffset(row, column)];
+        m_hash ^= cellKey(row, column, cell) ^ cellKey(row, column, value);
+        cell = value;
+    }
+    void clear(int row, int column) { set(row, column, EmptyCell); }
+    bool isEmpty(int row, int column) const { return at(row, column) == EmptyCell; }
+    void swapCells(int row1, int column1, int row2, int column2);
+    void fill(quint8 value);
+
+    quint64 hash() const { return m_hash; }
+    // Zobrist key of value at (row, column); zero for an empty cell. Keys
+    // are computed rather than tabled, so they do not depend on the board
+    // size and cost no memory on large boards.
+    static quint64 cellKey(int row, int column, quint8 value)
+    {
+        if (value == EmptyCell)
+            return 0;
+        quint64 z = (quint64(quint32(row)) << 32 | quint32(column) << 8 | value) + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    // Folds a cell written through mutableRowData() into the hash; call it
+    // for the old and the new value.
+    void toggleHash(int row, int column, quint8 value) { m_hash ^= cellKey(row, column, value); }
+
+    // Rows are contiguous within their chunk. mutableRowData() detaches
+    // the row's chunk first; the pointer stays valid until the board is
+    // copied or resized, so parallel writers fetch theirs up front. Writes
+    // through it bypass the hash, see toggleHash().
+    const quint8 *rowData(int row) const { return m_chunks.at(row >> m_chunkShift).constData() + chunkOffset(row, 0); }
+    quint8 *mutableRowData(int row) { return m_chunks[row >> m_chunkShift].data() + chunkOffset(row, 0); }
+    int chunkRowCount() const { return 1 << m_chunkShift; }
+    int chunkCount() const { return m_chunks.size(); }
+
+    const QStringList &palette() const { return m_palette; }
+    quint8 colorIndex(const QString &key) const;
+    quint8 internColor(const QString &key);
+    QString colorKey(quint8 value) const;
+
+    Q_INVOKABLE QString colorKeyAt(int row, int column) const;
+    Q_INVOKABLE int colorIndexAt(int row, int column) const;
+    Q_INVOKABLE QVariantList toMatrix() const;
+    // Color keys of a window of the board, clipped to its bounds; lets a
+    // view of a large board convert only what it shows.
+    Q_INVOKABLE QVariantList regionMatrix(int firstRow, int firstColumn, int rows, int columns) const;
+
+    static GridBoard fromMatrix(const QVariantList &matrix, int rows, int columns, const QStringList &palette);
+
+    bool operator==(const GridBoard &other) const;
+    bool operator!=(const GridBoard &other) const { return !(*this == other); }
+
+private:
+    int chunkOffset(int row, int column) const { return (row & ((1 << m_chunkShift) - 1)) * m_columnCount + column; }
+
+    int m_rowCount = 0;
+    int m_columnCount = 0;
+    int m_chunkShift = 0;
+    quint64 m_hash = 0;
+    QVector<QVector<quint8>> m_chunks;
+    QStringList m_palette;
+};
+
+Q_DECLARE_METATYPE(GridBoard)
+
+#endif // GRIDBOARD_H
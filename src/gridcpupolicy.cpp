@@ -0,0 +1,21 @@
+#include "gridcpupolicy.h"
+#include "gridturnsearch.h"
+
+bool GridCpuPolicy::chooseSwap(const GridSimulation &state, int swapsRemaining, GridSwap &swap) const
+{
+    if (isGreedy()) {
+        GridBoard board = state.board();
+        QList<GridSwap> ranked;
+        GridSimulation::rankSwaps(board, 1, ranked);
+        if (ranked.isEmpty())
+            return false;
+        swap = ranked.first();
+        return true;
+    }
+
+    const GridTurnPlan plan = GridTurnSearch::run(state, searchDepth(swapsRemaining), searchBudgetMs);
+    if (plan.swaps.isEmpty())
+        return false;
+    swap = plan.swaps.first();
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef GRIDCPUPOLICY_H
+#define GRIDCPUPOLICY_H
+
+#include "gridinstructions.h"
+#include "gridsimulation.h"
+
+#include <QtGlobal>
+
+// How a CPU player picks its next swap. With a lookahead of one swap and no
+// search budget it plays the best-ranked swap; otherwise it searches whole
+// turns of up to lookaheadSwaps swaps (never more than it has left) and
+// plays the first swap of the best plan. The match scene asks the
+// orchestrator to plan with it; headless tools call chooseSwap().
+struct GridCpuPolicy
+{
+    int lookaheadSwaps = 3;
+    int searchBudgetMs = 200;
+
+    bool isGreedy() const { return lookaheadSwaps <= 1 && searchBudgetMs <= 0; }
+    int searchDepth(int swapsRemaining) const { return qMax(1, qMin(lookaheadSwaps, swapsRemaining)); }
+
+    // Decides on the calling thread, searching there too. Returns false
+    // when the board has no legal swap.
+    bool chooseSwap(const GridSimulation &state, int swapsRemaining, GridSwap &swap) const;
+};
+
+#endif // GRIDCPUPOLICY_H
@@ -0,0 +1,100 @@
+#include "gridduel.h"
+
+#include <QElapsedTimer>
+
+namespace {
+GridSimulation generate(const GridDuelRules &rules, GridBoard board, GridSpawnStream spawns)
+{
+    GridSimulation::generateBoard(board, spawns);
+    return GridSimulation(board, spawns, rules.fillDirection);
+}
+
+void charge(const GridDuelRules &rules, const QList<GridCascadeEvent> &timeline, int side,
+            QVector<int> &charges, GridDuelResult &result)
+{
+    const int opponent = 1 - side;
+    for (const GridCascadeEvent &event : timeline) {
+        if (event.kind != GridCascadeEvent::Launch)
+            continue;
+        ++result.launched[side];
+        result.health[opponent] -= rules.cellDamage;
+        for (int slot = 0; slot < rules.loadout.size(); ++slot) {
+            if (rules.loadout.at(slot).color == event.color)
+                ++charges[slot];
+        }
+    }
+
+    for (int slot = 0; slot < rules.loadout.size(); ++slot) {
+        const GridDuelPowerup &powerup = rules.loadout.at(slot);
+        while (charges.at(slot) >= qMax(1, powerup.energy)) {
+            charges[slot] -= qMax(1, powerup.energy);
+            ++result.powerupsFired[side];
+            if (powerup.kind == GridDuelPowerup::Support)
+                result.health[side] = qMin(rules.health, result.health[side] + powerup.hp);
+            else
+                result.health[opponent] -= powerup.hp;
+        }
+    }
+}
+}
+
+GridDuelRules::GridDuelRules()
+{
+    const auto powerup = [](int color, int energy, int hp, int kind) {
+        GridDuelPowerup entry;
+        entry.color = color;
+        entry.energy = energy;
+        entry.hp = hp;
+        entry.kind = kind;
+        return entry;
+    };
+    loadout << powerup(1, 52, 12, GridDuelPowerup::Assault)
+            << powerup(3, 22, 18, GridDuelPowerup::Support)
+            << powerup(2, 25, 15, GridDuelPowerup::Assault)
+            << powerup(4, 26, 10, GridDuelPowerup::Support);
+}
+
+GridDuelResult GridDuel::play(const GridDuelRules &rules, const GridCpuPolicy policies[2],
+                              const quint32 seeds[2], int firstSide)
+{
+    GridDuelResult result;
+    GridSimulation sides[2];
+    QVector<int> charges[2];
+    for (int side = 0; side < 2; ++side) {
+        result.health[side] = rules.health;
+        charges[side].fill(0, rules.loadout.size());
+        sides[side] = generate(rules, GridBoard(rules.rows, rules.columns),
+                               GridSpawnStream(seeds[side], rules.colorCount, rules.columns));
+    }
+
+    QList<GridCascadeEvent> timeline;
+    QElapsedTimer clock;
+    int side = firstSide == 1 ? 1 : 0;
+    for (int turn = 0; turn < rules.maxTurns; ++turn, side = 1 - side) {
+        result.turns = turn + 1;
+        GridSimulation &simulation = sides[side];
+        for (int swapsRemaining = rules.maxSwaps; swapsRemaining > 0; --swapsRemaining) {
+            GridSwap swap;
+            clock.start();
+            const bool found = policies[side].chooseSwap(simulation, swapsRemaining, swap);
+            result.decisionNs[side].append(clock.nsecsElapsed());
+            if (!found) {
+                simulation = generate(rules, simulation.board(), simulation.spawns());
+                break;
+            }
+
+            simulation.swap(swap.row1, swap.column1, swap.row2, swap.column2);
+            timeline.clear();
+            simulation.settle(&timeline);
+            charge(rules, timeline, side, charges[side], result);
+            if (result.health[1 - side] <= 0) {
+                result.winner = side;
+                return result;
+            }
+        }
+    }
+
+    if (result.health[0] != result.health[1])
+        result.winner = result.health[0] > result.health[1] ? 0 : 1;
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef GRIDDUEL_H
+#define GRIDDUEL_H
+
+#include "gridcpupolicy.h"
+
+#include <QVector>
+
+// A powerup slot in a headless match. Launched cells of its color charge
+// it; once the charge reaches energy it fires and the charge drops by
+// energy. Assault powerups deal hp damage to the opponent, Support
+// powerups restore hp health to their owner.
+struct GridDuelPowerup
+{
+    enum Kind {
+        Assault = 0,
+        Support = 1
+    };
+
+    int color = 1;
+    int energy = 1;
+    int hp = 0;
+    int kind = Assault;
+};
+
+// Rules of a headless two-sided match. Sides alternate turns of maxSwaps
+// swaps, each swap settled with its cascade; every launched cell deals
+// cellDamage to the opponent and charges the side's powerups. A side with
+// no legal swap reshuffles and its turn ends. The first side to bring the
+// other to zero health wins; after maxTurns the healthier side wins.
+struct GridDuelRules
+{
+    int rows = 6;
+    int columns = 6;
+    int colorCount = 4;
+    int fillDirection = 1;
+    int maxSwaps = 3;
+    int health = 250;
+    int cellDamage = 1;
+    int maxTurns = 200;
+    // Shared by both sides. The defaults mirror DefaultPowerupRepository
+    // with its PowerupEnergyModel costs, colors in palette order
+    // (red, green, blue, yellow).
+    QVector<GridDuelPowerup> loadout;
+
+    GridDuelRules();
+};
+
+struct GridDuelResult
+{
+    // Side index, or -1 for a draw.
+    int winner = -1;
+    int turns = 0;
+    int health[2] = {};
+    int launched[2] = {};
+    int powerupsFired[2] = {};
+    // Wall time of every decision each side made, in nanoseconds.
+    QVector<qint64> decisionNs[2];
+};
+
+// Plays one match to the end on the calling thread. Side s starts from a
+// board generated with seeds[s]; side firstSide moves first.
+class GridDuel
+{
+public:
+    static GridDuelResult play(const GridDuelRules &rules, const GridCpuPolicy policies[2],
+                               const quint32 seeds[2], int firstSide);
+};
+
+#endif // GRIDDUEL_H
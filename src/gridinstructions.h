@@ -0,0 +1,192 @@
+#ifndef GRIDINSTRUCTIONS_H
+#define GRIDINSTRUCTIONS_H
+
+#include <QList>
+#include <QMetaType>
+
+// Typed orchestrator results. Internals fill caller-owned QList buffers of
+// these; the QML entry points flatten them into packed QList<int> triplets
+// ({ fromRow, toRow, column }, { column, targetRow, color } and
+// { row, column, color }) or five-int records for cascade timelines
+// ({ step, kind, row, column, value }) and ranked swaps ({ row1, column1,
+// row2, column2, score }), or eight-int match shapes ({ shape, color,
+// size, length, top, left, bottom, right }) so no per-element maps are
+// built.
+// Colors are GridBoard cell values (1-based palette indices).
+
+class GridMove
+{
+    Q_GADGET
+    Q_PROPERTY(int fromRow MEMBER fromRow)
+    Q_PROPERTY(int toRow MEMBER toRow)
+    Q_PROPERTY(int column MEMBER column)
+
+public:
+    int fromRow = 0;
+    int toRow = 0;
+    int column = 0;
+
+    bool operator==(const GridMove &other) const
+    {
+        return fromRow == other.fromRow && toRow == other.toRow && column == other.column;
+    }
+};
+
+class GridSpawn
+{
+    Q_GADGET
+    Q_PROPERTY(int column MEMBER column)
+    Q_PROPERTY(int targetRow MEMBER targetRow)
+    Q_PROPERTY(int spawnRow MEMBER spawnRow)
+    Q_PROPERTY(int color MEMBER color)
+    Q_PROPERTY(int hp MEMBER hp)
+
+public:
+    int column = 0;
+    int targetRow = 0;
+    int spawnRow = 0;
+    int color = 0;
+    int hp = 0;
+
+    bool operator==(const GridSpawn &other) const
+    {
+        return column == other.column && targetRow == other.targetRow
+            && spawnRow == other.spawnRow && color == other.color && hp == other.hp;
+    }
+};
+
+class GridMatch
+{
+    Q_GADGET
+    Q_PROPERTY(int row MEMBER row)
+    Q_PROPERTY(int column MEMBER column)
+    Q_PROPERTY(int color MEMBER color)
+
+public:
+    int row = 0;
+    int column = 0;
+    int color = 0;
+
+    bool operator==(const GridMatch &other) const
+    {
+        return row == other.row && column == other.column && color == other.color;
+    }
+};
+
+class GridSwap
+{
+    Q_GADGET
+    Q_PROPERTY(int row1 MEMBER row1)
+    Q_PROPERTY(int column1 MEMBER column1)
+    Q_PROPERTY(int row2 MEMBER row2)
+    Q_PROPERTY(int column2 MEMBER column2)
+    Q_PROPERTY(int score MEMBER score)
+
+public:
+    int row1 = 0;
+    int column1 = 0;
+    int row2 = 0;
+    int column2 = 0;
+    int score = 0;
+
+    bool operator==(const GridSwap &other) const
+    {
+        return row1 == other.row1 && column1 == other.column1 && row2 == other.row2
+            && column2 == other.column2 && score == other.score;
+    }
+};
+
+// One entry of a resolved cascade. Events sharing a step play together;
+// steps play in order. Spawns land at (row, column), moves go from row to
+// toRow, matches mark cells that the following launch step removes.
+class GridCascadeEvent
+{
+    Q_GADGET
+    Q_PROPERTY(int step MEMBER step)
+    Q_PROPERTY(int kind MEMBER kind)
+    Q_PROPERTY(int row MEMBER row)
+    Q_PROPERTY(int column MEMBER column)
+    Q_PROPERTY(int toRow MEMBER toRow)
+    Q_PROPERTY(int color MEMBER color)
+
+public:
+    enum Kind {
+        Spawn = 0,
+        Move = 1,
+        Match = 2,
+        Launch = 3
+    };
+    Q_ENUM(Kind)
+
+    int step = 0;
+    int kind = Spawn;
+    int row = 0;
+    int column = 0;
+    int toRow = 0;
+    int color = 0;
+
+    bool operator==(const GridCascadeEvent &other) const
+    {
+        return step == other.step && kind == other.kind && row == other.row
+            && column == other.column && toRow == other.toRow && color == other.color;
+    }
+};
+
+// One connected group of matched cells: the runs of three or more that
+// share a cell. length is the longest straight run in it. L, T and Cross
+// are one horizontal and one vertical run meeting at both ends, at one
+// end and in the middle of the other, or in both middles; anything with
+// more than two runs is a Cluster.
+class GridMatchShape
+{
+    Q_GADGET
+    Q_PROPERTY(int shape MEMBER shape)
+    Q_PROPERTY(int color MEMBER color)
+    Q_PROPERTY(int size MEMBER size)
+    Q_PROPERTY(int length MEMBER length)
+    Q_PROPERTY(int top MEMBER top)
+    Q_PROPERTY(int left MEMBER left)
+    Q_PROPERTY(int bottom MEMBER bottom)
+    Q_PROPERTY(int right MEMBER right)
+
+public:
+    enum Shape {
+        Line = 0,
+        LShape = 1,
+        TShape = 2,
+        Cross = 3,
+        Cluster = 4
+    };
+    Q_ENUM(Shape)
+
+    int shape = Line;
+    int color = 0;
+    int size = 0;
+    int length = 0;
+    int top = 0;
+    int left = 0;
+    int bottom = 0;
+    int right = 0;
+
+    bool operator==(const GridMatchShape &other) const
+    {
+        return shape == other.shape && color == other.color && size == other.size && length == other.length
+            && top == other.top && left == other.left && bottom == other.bottom && right == other.right;
+    }
+};
+
+Q_DECLARE_TYPEINFO(GridMove, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GridSpawn, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GridMatch, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GridSwap, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GridCascadeEvent, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(GridMatchShape, Q_PRIMITIVE_TYPE);
+
+Q_DECLARE_METATYPE(GridMove)
+Q_DECLARE_METATYPE(GridSpawn)
+Q_DECLARE_METATYPE(GridMatch)
+Q_DECLARE_METATYPE(GridSwap)
+Q_DECLARE_METATYPE(GridCascadeEvent)
+Q_DECLARE_METATYPE(GridMatchShape)
+
+#endif // GRIDINSTRUCTIONS_H
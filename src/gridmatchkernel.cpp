@@ -0,0 +1,239 @@
+#include "gridmatchkernel.h"
+#include "gridparallel.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GRIDMATCH_USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRIDMATCH_USE_SSE2
+#endif
+
+namespace {
+
+struct ScalarLane
+{
+    using Vec = quint64;
+    static constexpr int Width = 1;
+    static Vec load(const quint64 *p) { return *p; }
+    static void store(quint64 *p, Vec v) { *p = v; }
+    static Vec band(Vec a, Vec b) { return a & b; }
+    static Vec bor(Vec a, Vec b) { return a | b; }
+    template<int N> static Vec shr(Vec v) { return v >> N; }
+    template<int N> static Vec shl(Vec v) { return v << N; }
+};
+
+#if defined(GRIDMATCH_USE_AVX2)
+struct Avx2Lane
+{
+    using Vec = __m256i;
+    static constexpr int Width = 4;
+    static Vec load(const quint64 *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static void store(quint64 *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static Vec band(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    static Vec bor(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    template<int N> static Vec shr(Vec v) { return _mm256_srli_epi64(v, N); }
+    template<int N> static Vec shl(Vec v) { return _mm256_slli_epi64(v, N); }
+};
+using NativeLane = Avx2Lane;
+#elif defined(GRIDMATCH_USE_SSE2)
+struct Sse2Lane
+{
+    using Vec = __m128i;
+    static constexpr int Width = 2;
+    static Vec load(const quint64 *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static void store(quint64 *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    static Vec band(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static Vec bor(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    template<int N> static Vec shr(Vec v) { return _mm_srli_epi64(v, N); }
+    template<int N> static Vec shl(Vec v) { return _mm_slli_epi64(v, N); }
+};
+using NativeLane = Sse2Lane;
+#else
+using NativeLane = ScalarLane;
+#endif
+
+// out[i] = starts of horizontal triples: b & b>>1 & b>>2, carrying bits in
+// from the next word of the same row (the pad word ends each row).
+template<typename L>
+void rowTriples(const quint64 *plane, quint64 *out, int begin, int end)
+{
+    int i = begin;
+    for (; i + L::Width <= end; i += L::Width) {
+        const auto b = L::load(plane + i);
+        const auto next = L::load(plane + i + 1);
+        const auto b1 = L::bor(L::template shr<1>(b), L::template shl<63>(next));
+        const auto b2 = L::bor(L::template shr<2>(b), L::template shl<62>(next));
+        L::store(out + i, L::band(b, L::band(b1, b2)));
+    }
+    if constexpr (L::Width > 1)
+        rowTriples<ScalarLane>(plane, out, i, end);
+}
+
+// mask[i] |= t | t<<1 | t<<2, carrying bits in from the previous word.
+template<typename L>
+void rowMarks(const quint64 *triples, quint64 *mask, int begin, int end)
+{
+    int i = begin;
+    for (; i + L::Width <= end; i += L::Width) {
+        const auto t = L::load(triples + i);
+        const auto prev = L::load(triples + i - 1);
+        const auto t1 = L::bor(L::template shl<1>(t), L::template shr<63>(prev));
+        const auto t2 = L::bor(L::template shl<2>(t), L::template shr<62>(prev));
+        const auto m = L::bor(L::load(mask + i), L::bor(t, L::bor(t1, t2)));
+        L::store(mask + i, m);
+    }
+    if constexpr (L::Width > 1)
+        rowMarks<ScalarLane>(triples, mask, i, end);
+}
+
+// out[i] = starts of vertical triples: P[r] & P[r+1] & P[r+2].
+template<typename L>
+void columnTriples(const quint64 *plane, quint64 *out, int stride, int begin, int end)
+{
+    int i = begin;
+    for (; i + L::Width <= end; i += L::Width) {
+        const auto v = L::band(L::load(plane + i),
+                               L::band(L::load(plane + i + stride), L::load(plane + i + 2 * stride)));
+        L::store(out + i, v);
+    }
+    if constexpr (L::Width > 1)
+        columnTriples<ScalarLane>(plane, out, stride, i, end);
+}
+
+// mask[i] |= V[r] | V[r-1] | V[r-2].
+template<typename L>
+void columnMarks(const quint64 *triples, quint64 *mask, int stride, int begin, int end)
+{
+    int i = begin;
+    for (; i + L::Width <= end; i += L::Width) {
+        const auto v = L::bor(L::load(triples + i),
+                              L::bor(L::load(triples + i - stride), L::load(triples + i - 2 * stride)));
+        L::store(mask + i, L::bor(L::load(mask + i), v));
+    }
+    if constexpr (L::Width > 1)
+        columnMarks<ScalarLane>(triples, mask, stride, i, end);
+}
+
+} // namespace
+
+void GridMatchKernel::load(const GridBoard &board, bool parallel)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    const int colors = board.palette().size();
+
+    if (rows != m_rows || columns != m_columns || colors != m_colors) {
+        m_rows = rows;
+        m_columns = columns;
+        m_colors = colors;
+        m_words = (columns + 63) / 64;
+        // One leading pad word per row plus a trailing one after the last
+        // row; head and tail margins keep vector loads at i - 2 * stride and
+        // i + 2 * stride + width inside the buffer.
+        m_stride = m_words + 1;
+        m_head = 2 * m_stride + 4;
+        m_span = rows * m_stride + 1;
+        m_planeSize = m_head + m_span + m_head;
+        m_scratch.fill(0, m_planeSize);
+        m_bandScratch.clear();
+        m_mask.fill(0, m_planeSize);
+    }
+
+    m_planes.fill(0, m_colors * m_planeSize);
+    m_matchCount = 0;
+    if (!board.isValid())
+        return;
+
+    if (!parallel) {
+        loadRows(board, 0, rows);
+        return;
+    }
+    m_planes.detach();
+    GridParallel::run(GridParallel::bandCount(rows, BandRows), [this, &board, rows](int band) {
+        loadRows(board, band * BandRows, qMin(rows, (band + 1) * BandRows));
+    });
+}
+
+void GridMatchKernel::loadRows(const GridBoard &board, int firstRow, int lastRow)
+{
+    quint64 *planes = m_planes.data();
+    for (int row = firstRow; row < lastRow; ++row) {
+        const quint8 *cells = board.rowData(row);
+        const int offset = rowOffset(row);
+        for (int column = 0; column < m_columns; ++column) {
+            const quint8 value = cells[column];
+            if (value == GridBoard::EmptyCell || value > m_colors)
+                continue;
+            planes[(value - 1) * m_planeSize + offset + (column >> 6)] |= quint64(1) << (column & 63);
+        }
+    }
+}
+
+int GridMatchKernel::detect(bool parallel)
+{
+    m_matchCount = 0;
+    if (m_planeSize == 0)
+        return 0;
+
+    const int bands = GridParallel::bandCount(m_rows, BandRows);
+    if (!parallel || bands <= 1) {
+        m_matchCount = detectRange(m_head, m_head + m_span, m_scratch.data());
+        return m_matchCount;
+    }
+
+    // Band b covers the words of its rows including their leading pad
+    // words; the last band also takes the trailing pad word.
+    if (m_bandScratch.size() != bands) {
+        m_bandScratch.resize(bands);
+        for (QVector<quint64> &scratch : m_bandScratch)
+            scratch.fill(0, m_planeSize);
+    }
+    m_mask.detach();
+    QVector<int> counts(bands, 0);
+    GridParallel::run(bands, [this, bands, &counts](int band) {
+        const int begin = m_head + band * BandRows * m_stride;
+        const int end = (band == bands - 1) ? m_head + m_span : begin + BandRows * m_stride;
+        counts[band] = detectRange(begin, end, m_bandScratch[band].data());
+    });
+    for (const int count : std::as_const(counts))
+        m_matchCount += count;
+    return m_matchCount;
+}
+
+int GridMatchKernel::detectRange(int begin, int end, quint64 *scratch)
+{
+    quint64 *mask = m_mask.data();
+    std::fill(mask + begin, mask + end, quint64(0));
+
+    // rowMarks reads one triple word before begin and columnMarks the
+    // triples of the two rows above it, so those are recomputed here
+    // rather than taken from a neighbouring range.
+    const int rowHalo = begin - 1;
+    const int columnHalo = begin - 2 * m_stride;
+    for (int color = 0; color < m_colors; ++color) {
+        const quint64 *plane = m_planes.constData() + color * m_planeSize;
+        rowTriples<NativeLane>(plane, scratch, rowHalo, end);
+        rowMarks<NativeLane>(scratch, mask, begin, end);
+        columnTriples<NativeLane>(plane, scratch, m_stride, columnHalo, end);
+        columnMarks<NativeLane>(scratch, mask, m_stride, begin, end);
+    }
+
+    int count = 0;
+    for (int i = begin; i < end; ++i)
+        count += qPopulationCount(mask[i]);
+    return count;
+}
+
+const char *GridMatchKernel::backendName()
+{
+#if defined(GRIDMATCH_USE_AVX2)
+    return "avx2";
+#elif defined(GRIDMATCH_USE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
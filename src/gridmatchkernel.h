@@ -0,0 +1,77 @@
+#ifndef GRIDMATCHKERNEL_H
+#define GRIDMATCHKERNEL_H
+
+#include "gridboard.h"
+
+#include <QVector>
+#include <QtAlgorithms>
+
+// Bitboard match detector. Each palette color gets a plane holding one bit
+// per cell; runs of three are found with shift-and-AND (b & b>>1 & b>>2
+// along rows, P[r] & P[r+1] & P[r+2] down columns) and widened back into a
+// single match mask. Plane rows are separated by zero pad words so both
+// passes run as flat loops over the plane, vectorized with AVX2 or SSE2
+// when the compiler targets them and plain 64-bit words otherwise.
+//
+// With parallel set, load() and detect() split the board into bands of
+// BandRows rows on GridParallel. Horizontal runs never leave their row;
+// vertical runs crossing a band seam are caught by recomputing the triple
+// starts of the two rows above each band into the band's own scratch, so
+// every band writes only its own rows of the mask.
+class GridMatchKernel
+{
+public:
+    static constexpr int BandRows = 64;
+
+    void load(const GridBoard &board, bool parallel = false);
+    int detect(bool parallel = false);
+
+    int rowCount() const { return m_rows; }
+    int columnCount() const { return m_columns; }
+    int matchCount() const { return m_matchCount; }
+
+    bool isMatched(int row, int column) const
+    {
+        return (m_mask.at(wordIndex(row, column)) >> (column & 63)) & 1u;
+    }
+
+    // Calls visit(row, column) for every matched cell in row-major order.
+    template<typename Visitor>
+    void forEachMatch(Visitor visit) const
+    {
+        for (int row = 0; row < m_rows; ++row) {
+            const quint64 *words = m_mask.constData() + rowOffset(row);
+            for (int word = 0; word < m_words; ++word) {
+                quint64 bits = words[word];
+                while (bits) {
+                    visit(row, word * 64 + qCountTrailingZeroBits(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+
+    static const char *backendName();
+
+private:
+    int rowOffset(int row) const { return m_head + row * m_stride + 1; }
+    void loadRows(const GridBoard &board, int firstRow, int lastRow);
+    int detectRange(int begin, int end, quint64 *scratch);
+    int wordIndex(int row, int column) const { return rowOffset(row) + (column >> 6); }
+
+    int m_rows = 0;
+    int m_columns = 0;
+    int m_colors = 0;
+    int m_words = 0;
+    int m_stride = 0;
+    int m_head = 0;
+    int m_span = 0;
+    int m_planeSize = 0;
+    int m_matchCount = 0;
+    QVector<quint64> m_planes;
+    QVector<quint64> m_scratch;
+    QVector<QVector<quint64>> m_bandScratch;
+    QVector<quint64> m_mask;
+};
+
+#endif // GRIDMATCHKERNEL_H
@@ -0,0 +1,164 @@
+#include "gridmatchshapes.h"
+
+#include <algorithm>
+
+namespace {
+struct ShapeRuns
+{
+    int horizontal = 0;
+    int vertical = 0;
+    int lastHorizontal = -1;
+    int lastVertical = -1;
+};
+}
+
+int GridMatchShapes::analyze(const GridBoard &board, QList<GridMatchShape> &shapes)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    if (m_parent.size() != board.cellCount()) {
+        m_parent.fill(-1, board.cellCount());
+        m_slot.fill(-1, board.cellCount());
+    }
+    m_columns = columns;
+    m_cells.clear();
+    m_runs.clear();
+
+    for (int row = 0; row < rows; ++row) {
+        const quint8 *cells = board.rowData(row);
+        int column = 0;
+        while (column < columns) {
+            const quint8 value = cells[column];
+            int runEnd = column + 1;
+            if (value != GridBoard::EmptyCell) {
+                while (runEnd < columns && cells[runEnd] == value)
+                    ++runEnd;
+            }
+            if (value != GridBoard::EmptyCell && runEnd - column >= 3)
+                addRun(row * columns + column, runEnd - column, 1, true);
+            column = runEnd;
+        }
+    }
+    for (int column = 0; column < columns; ++column) {
+        int row = 0;
+        while (row < rows) {
+            const quint8 value = board.at(row, column);
+            int runEnd = row + 1;
+            if (value != GridBoard::EmptyCell) {
+                while (runEnd < rows && board.at(runEnd, column) == value)
+                    ++runEnd;
+            }
+            if (value != GridBoard::EmptyCell && runEnd - row >= 3)
+                addRun(row * columns + column, runEnd - row, columns, false);
+            row = runEnd;
+        }
+    }
+    if (m_cells.isEmpty())
+        return 0;
+
+    // Row-major order makes the shape order independent of which pass
+    // found a cell first.
+    std::sort(m_cells.begin(), m_cells.end());
+    const int firstShape = shapes.size();
+    for (const int cell : std::as_const(m_cells)) {
+        const int root = find(cell);
+        const int row = cell / columns;
+        const int column = cell % columns;
+        if (m_slot.at(root) < 0) {
+            m_slot[root] = shapes.size();
+            GridMatchShape shape;
+            shape.color = board.at(row, column);
+            shape.top = shape.bottom = row;
+            shape.left = shape.right = column;
+            shapes.append(shape);
+        }
+        GridMatchShape &shape = shapes[m_slot.at(root)];
+        ++shape.size;
+        shape.top = qMin(shape.top, row);
+        shape.bottom = qMax(shape.bottom, row);
+        shape.left = qMin(shape.left, column);
+        shape.right = qMax(shape.right, column);
+    }
+
+    QVector<ShapeRuns> runs(shapes.size() - firstShape);
+    for (int i = 0; i < m_runs.size(); ++i) {
+        const Run &run = m_runs.at(i);
+        const int slot = m_slot.at(find(run.first));
+        ShapeRuns &counts = runs[slot - firstShape];
+        if (run.horizontal) {
+            ++counts.horizontal;
+            counts.lastHorizontal = i;
+        } else {
+            ++counts.vertical;
+            counts.lastVertical = i;
+        }
+        GridMatchShape &shape = shapes[slot];
+        shape.length = qMax(shape.length, run.length);
+    }
+
+    for (int slot = firstShape; slot < shapes.size(); ++slot) {
+        const ShapeRuns &counts = runs.at(slot - firstShape);
+        GridMatchShape &shape = shapes[slot];
+        if (counts.horizontal + counts.vertical == 1) {
+            shape.shape = GridMatchShape::Line;
+        } else if (counts.horizontal == 1 && counts.vertical == 1) {
+            // The two runs share exactly one cell: the horizontal run's row
+            // and the vertical run's column.
+            const Run &across = m_runs.at(counts.lastHorizontal);
+            const Run &down = m_runs.at(counts.lastVertical);
+            const int row = across.first / columns;
+            const int column = down.first % columns;
+            const int left = across.first % columns;
+            const int top = down.first / columns;
+            const bool acrossEnd = column == left || column == left + across.length - 1;
+            const bool downEnd = row == top || row == top + down.length - 1;
+            if (acrossEnd && downEnd)
+                shape.shape = GridMatchShape::LShape;
+            else if (acrossEnd || downEnd)
+                shape.shape = GridMatchShape::TShape;
+            else
+                shape.shape = GridMatchShape::Cross;
+        } else {
+            shape.shape = GridMatchShape::Cluster;
+        }
+    }
+
+    for (const int cell : std::as_const(m_cells)) {
+        m_slot[cell] = -1;
+        m_parent[cell] = -1;
+    }
+    return m_cells.size();
+}
+
+void GridMatchShapes::addRun(int first, int length, int stride, bool horizontal)
+{
+    Run run;
+    run.first = first;
+    run.length = length;
+    run.horizontal = horizontal;
+    m_runs.append(run);
+
+    int root = -1;
+    for (int i = 0; i < length; ++i) {
+        const int cell = first + i * stride;
+        if (m_parent.at(cell) < 0) {
+            m_parent[cell] = cell;
+            m_cells.append(cell);
+        }
+        const int cellRoot = find(cell);
+        if (root < 0)
+            root = cellRoot;
+        else if (cellRoot != root)
+            m_parent[cellRoot] = root;
+    }
+}
+
+int GridMatchShapes::find(int cell)
+{
+    // Path halving.
+    while (m_parent.at(cell) != cell) {
+        m_parent[cell] = m_parent.at(m_parent.at(cell));
+        cell = m_parent.at(cell);
+    }
+    return cell;
+}
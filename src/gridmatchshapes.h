@@ -0,0 +1,43 @@
+#ifndef GRIDMATCHSHAPES_H
+#define GRIDMATCHSHAPES_H
+
+#include "gridboard.h"
+#include "gridinstructions.h"
+
+#include <QList>
+#include <QVector>
+
+// Groups the matched cells of a board into shapes in one scan. Every run of
+// three or more is found row by row and column by column, its cells are
+// joined in a union-find forest, and a final walk over the matched cells
+// collects size, color and bounding box per component before each is
+// classified from its runs. Cells joined only by sitting side by side (two
+// parallel runs) stay separate shapes. Buffers are kept between calls and
+// only the touched cells are cleared, so cost follows the matched cells
+// plus one read of the board.
+class GridMatchShapes
+{
+public:
+    // Appends one shape per component, ordered by each shape's first cell
+    // in row-major order. Returns the number of matched cells.
+    int analyze(const GridBoard &board, QList<GridMatchShape> &shapes);
+
+private:
+    struct Run
+    {
+        int first = 0;
+        int length = 0;
+        bool horizontal = true;
+    };
+
+    void addRun(int first, int length, int stride, bool horizontal);
+    int find(int cell);
+
+    int m_columns = 0;
+    QVector<int> m_parent;
+    QVector<int> m_slot;
+    QVector<int> m_cells;
+    QVector<Run> m_runs;
+};
+
+#endif // GRIDMATCHSHAPES_H
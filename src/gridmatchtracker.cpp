@@ -0,0 +1,172 @@
+#include "gridmatchtracker.h"
+#include "gridparallel.h"
+
+void GridMatchTracker::reset(const GridBoard &board)
+{
+    m_rows = board.rowCount();
+    m_columns = board.columnCount();
+    m_matchCount = 0;
+    m_rowRuns.fill(0, board.cellCount());
+    m_columnRuns.fill(0, board.cellCount());
+    m_rowMatched.fill(0, m_rows);
+    m_rowDirty.fill(0, m_rows);
+    m_columnDirty.fill(0, m_columns);
+    m_dirtyRows.clear();
+    m_dirtyColumns.clear();
+    markAllDirty();
+}
+
+void GridMatchTracker::markCellDirty(int row, int column)
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns)
+        return;
+    markRowDirty(row);
+    markColumnDirty(column);
+}
+
+void GridMatchTracker::markAllDirty()
+{
+    for (int row = 0; row < m_rows; ++row)
+        markRowDirty(row);
+    for (int column = 0; column < m_columns; ++column)
+        markColumnDirty(column);
+}
+
+void GridMatchTracker::markRowDirty(int row)
+{
+    if (m_rowDirty.at(row))
+        return;
+    m_rowDirty[row] = 1;
+    m_dirtyRows.append(row);
+}
+
+void GridMatchTracker::markColumnDirty(int column)
+{
+    if (m_columnDirty.at(column))
+        return;
+    m_columnDirty[column] = 1;
+    m_dirtyColumns.append(column);
+}
+
+int GridMatchTracker::update(const GridBoard &board, bool parallel)
+{
+    if (board.rowCount() != m_rows || board.columnCount() != m_columns)
+        reset(board);
+
+    if (parallel) {
+        updateParallel(board);
+    } else {
+        for (const int row : std::as_const(m_dirtyRows))
+            rescanRow(board, row, true);
+        for (const int column : std::as_const(m_dirtyColumns))
+            rescanColumn(board, column, true);
+    }
+
+    for (const int row : std::as_const(m_dirtyRows))
+        m_rowDirty[row] = 0;
+    for (const int column : std::as_const(m_dirtyColumns))
+        m_columnDirty[column] = 0;
+    m_dirtyRows.clear();
+    m_dirtyColumns.clear();
+    return m_matchCount;
+}
+
+void GridMatchTracker::updateParallel(const GridBoard &board)
+{
+    m_rowRuns.detach();
+    m_columnRuns.detach();
+    m_rowMatched.detach();
+
+    // Dirty rows only write their own row of m_rowRuns and dirty columns
+    // only their own column of m_columnRuns.
+    const int rowBands = GridParallel::bandCount(m_dirtyRows.size(), BandLines);
+    GridParallel::run(rowBands, [this, &board](int band) {
+        const int last = qMin(m_dirtyRows.size(), (band + 1) * BandLines);
+        for (int i = band * BandLines; i < last; ++i)
+            rescanRow(board, m_dirtyRows.at(i), false);
+    });
+    const int columnBands = GridParallel::bandCount(m_dirtyColumns.size(), BandLines);
+    GridParallel::run(columnBands, [this, &board](int band) {
+        const int last = qMin(m_dirtyColumns.size(), (band + 1) * BandLines);
+        for (int i = band * BandLines; i < last; ++i)
+            rescanColumn(board, m_dirtyColumns.at(i), false);
+    });
+
+    // A dirty column can change the count of any row.
+    const bool allRows = !m_dirtyColumns.isEmpty();
+    const int lines = allRows ? m_rows : m_dirtyRows.size();
+    const int bands = GridParallel::bandCount(lines, BandLines);
+    QVector<int> deltas(bands, 0);
+    GridParallel::run(bands, [this, allRows, lines, &deltas](int band) {
+        const int last = qMin(lines, (band + 1) * BandLines);
+        int delta = 0;
+        for (int i = band * BandLines; i < last; ++i) {
+            const int row = allRows ? i : m_dirtyRows.at(i);
+            const int count = countRow(row);
+            delta += count - m_rowMatched.at(row);
+            m_rowMatched[row] = count;
+        }
+        deltas[band] = delta;
+    });
+    for (const int delta : std::as_const(deltas))
+        m_matchCount += delta;
+}
+
+int GridMatchTracker::countRow(int row) const
+{
+    const quint8 *horizontal = m_rowRuns.constData() + row * m_columns;
+    const quint8 *vertical = m_columnRuns.constData() + row * m_columns;
+    int count = 0;
+    for (int column = 0; column < m_columns; ++column)
+        count += (horizontal[column] | vertical[column]) ? 1 : 0;
+    return count;
+}
+
+void GridMatchTracker::rescanRow(const GridBoard &board, int row, bool counted)
+{
+    const quint8 *cells = board.rowData(row);
+    int column = 0;
+    while (column < m_columns) {
+        const quint8 value = cells[column];
+        int runEnd = column + 1;
+        if (value != GridBoard::EmptyCell) {
+            while (runEnd < m_columns && cells[runEnd] == value)
+                ++runEnd;
+        }
+        const quint8 flag = (value != GridBoard::EmptyCell && runEnd - column >= 3) ? 1 : 0;
+        for (int c = column; c < runEnd; ++c)
+            setRunFlag(m_rowRuns, m_columnRuns, row, c, flag, counted);
+        column = runEnd;
+    }
+}
+
+void GridMatchTracker::rescanColumn(const GridBoard &board, int column, bool counted)
+{
+    int row = 0;
+    while (row < m_rows) {
+        const quint8 value = board.at(row, column);
+        int runEnd = row + 1;
+        if (value != GridBoard::EmptyCell) {
+            while (runEnd < m_rows && board.at(runEnd, column) == value)
+                ++runEnd;
+        }
+        const quint8 flag = (value != GridBoard::EmptyCell && runEnd - row >= 3) ? 1 : 0;
+        for (int r = row; r < runEnd; ++r)
+            setRunFlag(m_columnRuns, m_rowRuns, r, column, flag, counted);
+        row = runEnd;
+    }
+}
+
+void GridMatchTracker::setRunFlag(QVector<quint8> &flags, const QVector<quint8> &other, int row, int column, quint8 flag,
+                                  bool counted)
+{
+    const int index = row * m_columns + column;
+    if (flags.at(index) == flag)
+        return;
+    flags[index] = flag;
+    if (!counted || other.at(index))
+        return;
+    const int delta = flag ? 1 : -1;
+    m_rowMatched[row] += delta;
+    m_matchCount += delta;
+}
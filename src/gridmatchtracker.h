@@ -0,0 +1,76 @@
+#ifndef GRIDMATCHTRACKER_H
+#define GRIDMATCHTRACKER_H
+
+#include "gridboard.h"
+
+#include <QVector>
+
+// Incremental match state for a board that changes through small deltas.
+// Horizontal runs only depend on their row and vertical runs only on their
+// column, so keeping one flag per cell for each direction and rescanning
+// just the rows and columns touched since the last update is exact.
+class GridMatchTracker
+{
+public:
+    static constexpr int BandLines = 64;
+
+    void reset(const GridBoard &board);
+
+    void markCellDirty(int row, int column);
+    void markAllDirty();
+
+    // With parallel set, dirty rows and dirty columns are rescanned in
+    // bands of BandLines on GridParallel. A run lies in one row or one
+    // column, so no band reaches across a seam; the per-row counts the
+    // rescans share are rebuilt afterwards instead of kept up to date.
+    int update(const GridBoard &board, bool parallel = false);
+
+    int matchCount() const { return m_matchCount; }
+    int dirtyRowCount() const { return m_dirtyRows.size(); }
+    int dirtyColumnCount() const { return m_dirtyColumns.size(); }
+
+    bool isMatched(int row, int column) const
+    {
+        const int index = row * m_columns + column;
+        return m_rowRuns.at(index) || m_columnRuns.at(index);
+    }
+
+    // Calls visit(row, column) for every matched cell in row-major order,
+    // skipping rows without matches.
+    template<typename Visitor>
+    void forEachMatch(Visitor visit) const
+    {
+        for (int row = 0; row < m_rows; ++row) {
+            if (m_rowMatched.at(row) == 0)
+                continue;
+            const int base = row * m_columns;
+            for (int column = 0; column < m_columns; ++column) {
+                if (m_rowRuns.at(base + column) || m_columnRuns.at(base + column))
+                    visit(row, column);
+            }
+        }
+    }
+
+private:
+    void markRowDirty(int row);
+    void markColumnDirty(int column);
+    void updateParallel(const GridBoard &board);
+    void rescanRow(const GridBoard &board, int row, bool counted);
+    void rescanColumn(const GridBoard &board, int column, bool counted);
+    void setRunFlag(QVector<quint8> &flags, const QVector<quint8> &other, int row, int column, quint8 flag,
+                    bool counted);
+    int countRow(int row) const;
+
+    int m_rows = 0;
+    int m_columns = 0;
+    int m_matchCount = 0;
+    QVector<quint8> m_rowRuns;
+    QVector<quint8> m_columnRuns;
+    QVector<int> m_rowMatched;
+    QVector<quint8> m_rowDirty;
+    QVector<quint8> m_columnDirty;
+    QVector<int> m_dirtyRows;
+    QVector<int> m_dirtyColumns;
+};
+
+#endif // GRIDMATCHTRACKER_H
@@ -0,0 +1,135 @@
+#include "gridmoveindex.h"
+
+namespace {
+// Reach of a run of three through a cell along a row or a column.
+static const int kMatchReach = 2;
+}
+
+void GridMoveIndex::reset(const GridBoard &board)
+{
+    m_rows = board.rowCount();
+    m_columns = board.columnCount();
+    m_moveCount = 0;
+    m_right.fill(0, board.cellCount());
+    m_down.fill(0, board.cellCount());
+    m_cellDirty.fill(0, board.cellCount());
+    m_dirtyCells.clear();
+    markAllDirty();
+}
+
+void GridMoveIndex::markCellDirty(int row, int column)
+{
+    if (m_allDirty || row < 0 || row >= m_rows || column < 0 || column >= m_columns)
+        return;
+    const int index = row * m_columns + column;
+    if (m_cellDirty.at(index))
+        return;
+    m_cellDirty[index] = 1;
+    m_dirtyCells.append(index);
+
+    // Past this many cells a full pass is cheaper than the rechecks.
+    if (m_dirtyCells.size() * 8 > m_rows * m_columns)
+        markAllDirty();
+}
+
+void GridMoveIndex::markAllDirty()
+{
+    m_allDirty = true;
+    for (const int index : std::as_const(m_dirtyCells))
+        m_cellDirty[index] = 0;
+    m_dirtyCells.clear();
+}
+
+int GridMoveIndex::update(const GridBoard &board)
+{
+    if (board.rowCount() != m_rows || board.columnCount() != m_columns)
+        reset(board);
+
+    if (m_allDirty) {
+        for (int row = 0; row < m_rows; ++row) {
+            for (int column = 0; column < m_columns; ++column)
+                recheckFrom(board, row, column);
+        }
+        m_allDirty = false;
+        return m_moveCount;
+    }
+
+    for (const int index : std::as_const(m_dirtyCells)) {
+        recheckAround(board, index / m_columns, index % m_columns);
+        m_cellDirty[index] = 0;
+    }
+    m_dirtyCells.clear();
+    return m_moveCount;
+}
+
+bool GridMoveIndex::createsMatch(const GridBoard &board, int row1, int column1, int row2, int column2)
+{
+    const quint8 first = board.at(row1, column1);
+    const quint8 second = board.at(row2, column2);
+    if (first == second || first == GridBoard::EmptyCell || second == GridBoard::EmptyCell)
+        return false;
+
+    // Reads the board as if the swap had been made.
+    const auto colorAt = [&](int row, int column) {
+        if (row == row1 && column == column1)
+            return second;
+        if (row == row2 && column == column2)
+            return first;
+        return board.at(row, column);
+    };
+    const auto runThrough = [&](int row, int column, quint8 color) {
+        int horizontal = 1;
+        for (int c = column - 1; c >= 0 && column - c <= kMatchReach && colorAt(row, c) == color; --c)
+            ++horizontal;
+        for (int c = column + 1; c < board.columnCount() && c - column <= kMatchReach && colorAt(row, c) == color; ++c)
+            ++horizontal;
+        if (horizontal >= 3)
+            return true;
+        int vertical = 1;
+        for (int r = row - 1; r >= 0 && row - r <= kMatchReach && colorAt(r, column) == color; --r)
+            ++vertical;
+        for (int r = row + 1; r < board.rowCount() && r - row <= kMatchReach && colorAt(r, column) == color; ++r)
+            ++vertical;
+        return vertical >= 3;
+    };
+    return runThrough(row1, column1, second) || runThrough(row2, column2, first);
+}
+
+void GridMoveIndex::recheckAround(const GridBoard &board, int row, int column)
+{
+    // Every swap with an end in the cross of reach around the changed cell.
+    for (int r = qMax(0, row - kMatchReach); r <= qMin(m_rows - 1, row + kMatchReach); ++r) {
+        recheckFrom(board, r, column);
+        if (r > 0)
+            recheckFrom(board, r - 1, column);
+        if (column > 0)
+            recheckFrom(board, r, column - 1);
+    }
+    for (int c = qMax(0, column - kMatchReach); c <= qMin(m_columns - 1, column + kMatchReach); ++c) {
+        if (c == column)
+            continue;
+        recheckFrom(board, row, c);
+        if (row > 0)
+            recheckFrom(board, row - 1, c);
+        if (c > 0)
+            recheckFrom(board, row, c - 1);
+    }
+}
+
+void GridMoveIndex::recheckFrom(const GridBoard &board, int row, int column)
+{
+    const int index = row * m_columns + column;
+    if (column + 1 < m_columns)
+        setMove(m_right, index, createsMatch(board, row, column, row, column + 1));
+    if (row + 1 < m_rows)
+        setMove(m_down, index, createsMatch(board, row, column, row + 1, column));
+}
+
+void GridMoveIndex::setMove(QVector<quint8> &moves, int index, bool legal)
+{
+    const quint8 flag = legal ? 1 : 0;
+    if (moves.at(index) == flag)
+        return;
+    moves[index] = flag;
+    m_moveCount += legal ? 1 : -1;
+}
@@ -0,0 +1,59 @@
+#ifndef GRIDMOVEINDEX_H
+#define GRIDMOVEINDEX_H
+
+#include "gridboard.h"
+
+#include <QVector>
+
+// Live set of the adjacent swaps that would create a match. Whether a swap
+// does only depends on the cells up to two steps along a row or a column
+// from either swapped cell, so a changed cell only rechecks the swaps with
+// an end inside that cross around it; update() costs O(changed cells).
+class GridMoveIndex
+{
+public:
+    void reset(const GridBoard &board);
+
+    void markCellDirty(int row, int column);
+    void markAllDirty();
+
+    int update(const GridBoard &board);
+
+    int moveCount() const { return m_moveCount; }
+    bool hasMove() const { return m_moveCount > 0; }
+
+    // Calls visit(row1, column1, row2, column2) for every indexed swap, in
+    // the order GridSimulation::rankSwaps() scans them.
+    template<typename Visitor>
+    void forEachMove(Visitor visit) const
+    {
+        for (int row = 0; row < m_rows; ++row) {
+            const int base = row * m_columns;
+            for (int column = 0; column < m_columns; ++column) {
+                if (m_right.at(base + column))
+                    visit(row, column, row, column + 1);
+                if (m_down.at(base + column))
+                    visit(row, column, row + 1, column);
+            }
+        }
+    }
+
+    static bool createsMatch(const GridBoard &board, int row1, int column1, int row2, int column2);
+
+private:
+    void recheckAround(const GridBoard &board, int row, int column);
+    void recheckFrom(const GridBoard &board, int row, int column);
+    void setMove(QVector<quint8> &moves, int index, bool legal);
+
+    int m_rows = 0;
+    int m_columns = 0;
+    int m_moveCount = 0;
+    bool m_allDirty = false;
+    // Flag per cell for the swap with its right and its lower neighbour.
+    QVector<quint8> m_right;
+    QVector<quint8> m_down;
+    QVector<quint8> m_cellDirty;
+    QVector<int> m_dirtyCells;
+};
+
+#endif // GRIDMOVEINDEX_H
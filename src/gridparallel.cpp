@@ -0,0 +1,68 @@
+#include "gridparallel.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+namespace {
+struct BandState
+{
+    std::function<void(int)> work;
+    int bandCount = 0;
+    QAtomicInt next;
+    QAtomicInt done;
+    QMutex mutex;
+    QWaitCondition finished;
+};
+
+void claimBands(BandState &state)
+{
+    for (;;) {
+        const int band = state.next.fetchAndAddRelaxed(1);
+        if (band >= state.bandCount)
+            return;
+        state.work(band);
+        if (state.done.fetchAndAddOrdered(1) + 1 == state.bandCount) {
+            QMutexLocker locker(&state.mutex);
+            state.finished.wakeAll();
+        }
+    }
+}
+}
+
+int GridParallel::bandCount(int items, int bandSize)
+{
+    if (items <= 0 || bandSize <= 0)
+        return 0;
+    return (items + bandSize - 1) / bandSize;
+}
+
+void GridParallel::run(int bandCount, const std::function<void(int band)> &work)
+{
+    if (bandCount <= 0)
+        return;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int helpers = qMin(bandCount, pool->maxThreadCount()) - 1;
+    if (helpers <= 0) {
+        for (int band = 0; band < bandCount; ++band)
+            work(band);
+        return;
+    }
+
+    // Helpers that start after every band is claimed return at once, but
+    // they may still outlive this call, hence the shared state.
+    const auto state = QSharedPointer<BandState>::create();
+    state->work = work;
+    state->bandCount = bandCount;
+    for (int i = 0; i < helpers; ++i)
+        pool->start([state]() { claimBands(*state); });
+    claimBands(*state);
+
+    QMutexLocker locker(&state->mutex);
+    while (state->done.loadAcquire() < bandCount)
+        state->finished.wait(&state->mutex);
+}
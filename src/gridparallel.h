@@ -0,0 +1,20 @@
+#ifndef GRIDPARALLEL_H
+#define GRIDPARALLEL_H
+
+#include <functional>
+
+// Blocking parallel loop over fixed bands of work for the large-board
+// paths. Bands are claimed from a shared counter by the calling thread and
+// by helpers on the global thread pool, so a pool that is busy (with a turn
+// search, say) only means the caller runs more bands itself; run() never
+// waits on a task that has not started. Band boundaries are chosen by the
+// caller and must not depend on the thread count, which keeps results
+// identical however many cores there are.
+class GridParallel
+{
+public:
+    static int bandCount(int items, int bandSize);
+    static void run(int bandCount, const std::function<void(int band)> &work);
+};
+
+#endif // GRIDPARALLEL_H
@@ -0,0 +1,186 @@
+#include "gridreplay.h"
+
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace {
+static const char kMagic[] = { 'B', 'W', 'R', 'P' };
+static const int kMagicSize = 4;
+static const quint64 kFormatVersion = 1;
+// Upper bound on a record's values or strings; anything larger is corrupt.
+static const quint64 kMaxRecordItems = 1u << 24;
+}
+
+GridReplayWriter::GridReplayWriter()
+{
+    m_data.append(kMagic, kMagicSize);
+    putVarint(kFormatVersion);
+}
+
+void GridReplayWriter::write(const GridReplayEvent &event)
+{
+    putVarint(quint64(event.kind));
+    putVarint(quint64(event.grid));
+    putVarint(quint64(event.values.size()));
+    for (const quint64 value : event.values)
+        putVarint(value);
+    putVarint(quint64(event.strings.size()));
+    for (const QString &text : event.strings) {
+        const QByteArray utf8 = text.toUtf8();
+        putVarint(quint64(utf8.size()));
+        m_data.append(utf8);
+    }
+}
+
+void GridReplayWriter::write(int kind, int grid, const QVector<quint64> &values)
+{
+    GridReplayEvent event;
+    event.kind = kind;
+    event.grid = grid;
+    event.values = values;
+    write(event);
+}
+
+bool GridReplayWriter::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(m_data);
+    return file.commit();
+}
+
+void GridReplayWriter::putVarint(quint64 value)
+{
+    char bytes[10];
+    int size = 0;
+    while (value >= 0x80) {
+        bytes[size++] = char(value | 0x80);
+        value >>= 7;
+    }
+    bytes[size++] = char(value);
+    m_data.append(bytes, size);
+}
+
+GridReplayReader::~GridReplayReader()
+{
+    close();
+}
+
+bool GridReplayReader::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = m_file.size();
+    m_mapped = size > 0 ? m_file.map(0, size) : nullptr;
+    if (m_mapped)
+        return start(m_mapped, size);
+
+    // Some file systems cannot be mapped; fall back to one read.
+    m_buffer = m_file.readAll();
+    m_file.close();
+    return start(reinterpret_cast<const uchar *>(m_buffer.constData()), m_buffer.size());
+}
+
+bool GridReplayReader::setData(const QByteArray &data)
+{
+    close();
+    m_buffer = data;
+    return start(reinterpret_cast<const uchar *>(m_buffer.constData()), m_buffer.size());
+}
+
+void GridReplayReader::close()
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+    m_buffer.clear();
+    m_begin = m_cursor = m_end = nullptr;
+    m_error = false;
+}
+
+bool GridReplayReader::next(GridReplayEvent &event)
+{
+    if (m_error || atEnd())
+        return false;
+
+    quint64 kind = 0;
+    quint64 grid = 0;
+    quint64 count = 0;
+    // Every value takes at least one byte, so a count larger than what is
+    // left is corrupt; checking it first keeps resize() from trusting it.
+    if (!getVarint(kind) || !getVarint(grid) || !getVarint(count) || count > kMaxRecordItems
+        || count > quint64(m_end - m_cursor)) {
+        m_error = true;
+        return false;
+    }
+    event.kind = int(kind);
+    event.grid = int(grid);
+    event.values.resize(int(count));
+    for (quint64 &value : event.values) {
+        if (!getVarint(value)) {
+            m_error = true;
+            return false;
+        }
+    }
+
+    event.strings.clear();
+    if (!getVarint(count) || count > kMaxRecordItems || count > quint64(m_end - m_cursor)) {
+        m_error = true;
+        return false;
+    }
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 size = 0;
+        if (!getVarint(size) || size > quint64(m_end - m_cursor)) {
+            m_error = true;
+            return false;
+        }
+        event.strings.append(QString::fromUtf8(reinterpret_cast<const char *>(m_cursor), int(size)));
+        m_cursor += size;
+    }
+    return true;
+}
+
+void GridReplayReader::rewind()
+{
+    if (!m_begin)
+        return;
+    // The header was validated by start().
+    quint64 version = 0;
+    m_cursor = m_begin + kMagicSize;
+    m_error = false;
+    getVarint(version);
+}
+
+bool GridReplayReader::start(const uchar *begin, qint64 size)
+{
+    m_end = begin + size;
+    quint64 version = 0;
+    m_cursor = begin + kMagicSize;
+    if (size < kMagicSize || memcmp(begin, kMagic, kMagicSize) != 0 || !getVarint(version)
+        || version != kFormatVersion) {
+        m_begin = m_cursor = m_end = nullptr;
+        m_error = true;
+        return false;
+    }
+    m_begin = begin;
+    return true;
+}
+
+bool GridReplayReader::getVarint(quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && m_cursor < m_end; shift += 7) {
+        const uchar byte = *m_cursor++;
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
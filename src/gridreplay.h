@@ -0,0 +1,101 @@
+#ifndef GRIDREPLAY_H
+#define GRIDREPLAY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+// One record of a replay stream. Every record is written as varints:
+// kind, grid, the value count and values, then the string count and
+// UTF-8 strings with their byte length. Values are unsigned; signed
+// arguments taken from QML (cell lists, swaps) are zigzag-encoded.
+struct GridReplayEvent
+{
+    enum Kind {
+        // rows, columns, zigzag fillDirection, seed, largeBoard; strings
+        // hold { key, hex, weight } per palette color. A Board record with
+        // the starting state follows.
+        Grid = 0,
+        Seed = 1,
+        Rewind = 2,
+        // Spawn counters, one per column.
+        Positions = 3,
+        Reset = 4,
+        // Every cell value (0 empty, else 1-based palette index) in
+        // row-major order, then every spawn counter.
+        Board = 5,
+        // Zigzag row1, column1, row2, column2.
+        Swap = 6,
+        // The zigzag-encoded argument of clearCells/commitMoves/commitSpawns.
+        Clear = 7,
+        Moves = 8,
+        Spawns = 9,
+        Cascade = 10,
+        Reshuffle = 11,
+        // Board hash at the end of a turn.
+        TurnEnd = 12,
+        // Powerup slot index.
+        Powerup = 13
+    };
+
+    int kind = Grid;
+    int grid = 0;
+    QVector<quint64> values;
+    QStringList strings;
+
+    static quint64 zigzag(qint64 value) { return (quint64(value) << 1) ^ quint64(value >> 63); }
+    static qint64 unzigzag(quint64 value) { return qint64(value >> 1) ^ -qint64(value & 1); }
+};
+
+// Appends records to an in-memory stream that starts with the file magic.
+class GridReplayWriter
+{
+public:
+    GridReplayWriter();
+
+    void write(const GridReplayEvent &event);
+    void write(int kind, int grid, const QVector<quint64> &values = QVector<quint64>());
+
+    const QByteArray &data() const { return m_data; }
+    bool save(const QString &path) const;
+
+private:
+    void putVarint(quint64 value);
+
+    QByteArray m_data;
+};
+
+// Reads records back in order. open() maps the file instead of reading it,
+// so a long recording costs no copy; setData() reads from memory.
+class GridReplayReader
+{
+public:
+    GridReplayReader() = default;
+    ~GridReplayReader();
+
+    bool open(const QString &path);
+    bool setData(const QByteArray &data);
+    void close();
+
+    // False at the end of the stream or on a malformed record; hasError()
+    // tells the two apart.
+    bool next(GridReplayEvent &event);
+    bool atEnd() const { return m_cursor == m_end; }
+    bool hasError() const { return m_error; }
+    void rewind();
+
+private:
+    bool start(const uchar *begin, qint64 size);
+    bool getVarint(quint64 &value);
+
+    QFile m_file;
+    uchar *m_mapped = nullptr;
+    QByteArray m_buffer;
+    const uchar *m_begin = nullptr;
+    const uchar *m_cursor = nullptr;
+    const uchar *m_end = nullptr;
+    bool m_error = false;
+};
+
+#endif // GRIDREPLAY_H
@@ -0,0 +1,421 @@
+#include "gridsimulation.h"
+#include "gridparallel.h"
+
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Guards against a spawn stream that keeps refilling matches forever.
+static const int kMaxCascadeSteps = 4096;
+quint64 colorBit(quint8 color)
+{
+    const bool masked = color != GridBoard::EmptyCell && color <= GridSpawnStream::MaxColors;
+    return masked ? (quint64(1) << (color - 1)) : 0;
+}
+
+quint64 pairBit(quint8 first, quint8 second)
+{
+    return first == second ? colorBit(first) : 0;
+}
+}
+
+GridSimulation::GridSimulation(const GridBoard &board, const GridSpawnStream &spawns, int fillDirection)
+    : m_board(board)
+    , m_spawns(spawns)
+    , m_fillDirection(fillDirection >= 0 ? 1 : -1)
+{
+    m_tracker.reset(m_board);
+}
+
+void GridSimulation::swap(int row1, int column1, int row2, int column2)
+{
+    m_board.swapCells(row1, column1, row2, column2);
+    m_tracker.markCellDirty(row1, column1);
+    m_tracker.markCellDirty(row2, column2);
+}
+
+int GridSimulation::settle(QList<GridCascadeEvent> *timeline)
+{
+    m_depth = 0;
+    if (!m_board.isValid() || !m_spawns.isValid())
+        return 0;
+
+    const auto append = [timeline](int step, int kind, int row, int column, int toRow, int color) {
+        if (!timeline)
+            return;
+        GridCascadeEvent event;
+        event.step = step;
+        event.kind = kind;
+        event.row = row;
+        event.column = column;
+        event.toRow = toRow;
+        event.color = color;
+        timeline->append(event);
+    };
+
+    // Compact, top up the front row and compact again until it is full,
+    // then launch matches and repeat.
+    const int front = frontRow(m_board, m_fillDirection);
+    int launched = 0;
+    int step = 0;
+    while (step < kMaxCascadeSteps) {
+        m_moves.clear();
+        compact(m_board, m_fillDirection, m_moves, m_largeBoard);
+        if (!m_moves.isEmpty()) {
+            for (const GridMove &move : std::as_const(m_moves)) {
+                m_tracker.markCellDirty(move.fromRow, move.column);
+                m_tracker.markCellDirty(move.toRow, move.column);
+                append(step, GridCascadeEvent::Move, move.fromRow, move.column, move.toRow,
+                       m_board.at(move.toRow, move.column));
+            }
+            ++step;
+        }
+
+        if (rowHasVacancy(m_board, front) && m_largeBoard) {
+            m_spawned.clear();
+            if (!fillVacancies(m_spawned))
+                return launched;
+            for (const GridSpawn &spawn : std::as_const(m_spawned)) {
+                m_tracker.markCellDirty(spawn.targetRow, spawn.column);
+                append(step, GridCascadeEvent::Spawn, spawn.targetRow, spawn.column, spawn.targetRow, spawn.color);
+            }
+            ++step;
+            continue;
+        }
+        if (rowHasVacancy(m_board, front)) {
+            for (int column = 0; column < m_board.columnCount(); ++column) {
+                if (!m_board.isEmpty(front, column))
+                    continue;
+                const quint8 color = pickSpawn(m_board, front, column, m_spawns);
+                if (color == GridBoard::EmptyCell)
+                    return launched;
+                setCell(front, column, color);
+                append(step, GridCascadeEvent::Spawn, front, column, front, color);
+            }
+            ++step;
+            continue;
+        }
+
+        m_matches.clear();
+        m_tracker.update(m_board, m_largeBoard);
+        m_tracker.forEachMatch([this](int row, int column) {
+            GridMatch match;
+            match.row = row;
+            match.column = column;
+            match.color = m_board.at(row, column);
+            m_matches.append(match);
+        });
+        if (m_matches.isEmpty())
+            break;
+
+        for (const GridMatch &match : std::as_const(m_matches))
+            append(step, GridCascadeEvent::Match, match.row, match.column, match.row, match.color);
+        ++step;
+        for (const GridMatch &match : std::as_const(m_matches)) {
+            setCell(match.row, match.column, GridBoard::EmptyCell);
+            append(step, GridCascadeEvent::Launch, match.row, match.column, match.row, match.color);
+        }
+        ++step;
+        launched += m_matches.size();
+        ++m_depth;
+    }
+
+    if (step >= kMaxCascadeSteps)
+        qWarning() << "GridSimulation: cascade stopped after" << step << "steps";
+    return launched;
+}
+
+int GridSimulation::frontRow(const GridBoard &board, int fillDirection)
+{
+    return (fillDirection >= 0) ? 0 : board.rowCount() - 1;
+}
+
+bool GridSimulation::rowHasVacancy(const GridBoard &board, int row)
+{
+    if (row < 0 || row >= board.rowCount())
+        return false;
+    const quint8 *cells = board.rowData(row);
+    return std::find(cells, cells + board.columnCount(), GridBoard::EmptyCell) != cells + board.columnCount();
+}
+
+void GridSimulation::compact(GridBoard &board, int fillDirection, QList<GridMove> &moves, bool parallel)
+{
+    if (!board.isValid())
+        return;
+
+    // Row pointers are taken once, detaching every chunk up front, so the
+    // bands below only ever write through raw pointers.
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    QVector<quint8 *> rowData(rows);
+    for (int row = 0; row < rows; ++row)
+        rowData[row] = board.mutableRowData(row);
+
+    const int firstMove = moves.size();
+    const int bands = GridParallel::bandCount(columns, BandColumns);
+    if (!parallel || bands <= 1) {
+        compactColumns(rowData.constData(), rows, 0, columns, fillDirection, moves);
+    } else {
+        // Columns are independent; concatenating the bands in order gives
+        // the same move list as the serial pass.
+        QVector<QList<GridMove>> bandMoves(bands);
+        GridParallel::run(bands, [&rowData, &bandMoves, rows, columns, fillDirection](int band) {
+            const int first = band * BandColumns;
+            compactColumns(rowData.constData(), rows, first, qMin(columns, first + BandColumns), fillDirection,
+                           bandMoves[band]);
+        });
+        for (const QList<GridMove> &band : std::as_const(bandMoves))
+            moves.append(band);
+    }
+
+    // Every move lands on a cell that is empty by then, so each one only
+    // shifts its color's key from the source row to the target row.
+    for (int i = firstMove; i < moves.size(); ++i) {
+        const GridMove &move = moves.at(i);
+        const quint8 value = board.at(move.toRow, move.column);
+        board.toggleHash(move.fromRow, move.column, value);
+        board.toggleHash(move.toRow, move.column, value);
+    }
+}
+
+void GridSimulation::compactColumns(quint8 *const *rows, int rowCount, int firstColumn, int lastColumn,
+                                    int fillDirection, QList<GridMove> &moves)
+{
+    const int firstRow = (fillDirection >= 0) ? rowCount - 1 : 0;
+    const int step = (fillDirection >= 0) ? -1 : 1;
+
+    for (int column = firstColumn; column < lastColumn; ++column) {
+        int writeRow = firstRow;
+        for (int row = firstRow; row >= 0 && row < rowCount; row += step) {
+            const quint8 value = rows[row][column];
+            if (value == GridBoard::EmptyCell)
+                continue;
+            if (row != writeRow) {
+                GridMove move;
+                move.fromRow = row;
+                move.toRow = writeRow;
+                move.column = column;
+                moves.append(move);
+                rows[writeRow][column] = value;
+                rows[row][column] = GridBoard::EmptyCell;
+            }
+            writeRow += step;
+        }
+        for (int row = writeRow; row >= 0 && row < rowCount; row += step)
+            rows[row][column] = GridBoard::EmptyCell;
+    }
+}
+
+bool GridSimulation::fillVacancies(QList<GridSpawn> &spawns)
+{
+    const int rows = m_board.rowCount();
+    const int columns = m_board.columnCount();
+    if (m_spawns.columnCount() < columns)
+        return false;
+    QVector<quint8 *> rowData(rows);
+    for (int row = 0; row < rows; ++row)
+        rowData[row] = m_board.mutableRowData(row);
+    m_spawns.detach();
+
+    // A spawn looks two columns to each side, so even bands are filled
+    // first and odd bands second; no band then reads a column another
+    // thread is writing, and the outcome only depends on the band width.
+    const int bands = GridParallel::bandCount(columns, BandColumns);
+    QVector<QList<GridSpawn>> bandSpawns(bands);
+    for (int parity = 0; parity < 2; ++parity) {
+        GridParallel::run((bands + 1 - parity) / 2, [this, &rowData, &bandSpawns, columns, parity](int index) {
+            const int band = 2 * index + parity;
+            const int last = qMin(columns, (band + 1) * BandColumns);
+            for (int column = band * BandColumns; column < last; ++column)
+                fillColumn(rowData.constData(), column, bandSpawns[band]);
+        });
+    }
+    for (const QList<GridSpawn> &band : std::as_const(bandSpawns)) {
+        for (const GridSpawn &spawn : band)
+            m_board.toggleHash(spawn.targetRow, spawn.column, spawn.color);
+        spawns.append(band);
+    }
+    return true;
+}
+
+void GridSimulation::fillColumn(quint8 *const *rows, int column, QList<GridSpawn> &spawns)
+{
+    // After compaction the vacancies run from the front row to the first
+    // block. Fill them deepest first, the order the row-by-row fill would
+    // have stacked them in.
+    const int rowCount = m_board.rowCount();
+    const int front = frontRow(m_board, m_fillDirection);
+    const int step = (m_fillDirection >= 0) ? 1 : -1;
+    int deepest = front - step;
+    while (deepest + step >= 0 && deepest + step < rowCount && rows[deepest + step][column] == GridBoard::EmptyCell)
+        deepest += step;
+
+    for (int row = deepest; row != front - step; row -= step) {
+        const quint8 color = pickSpawn(m_board, row, column, m_spawns);
+        rows[row][column] = color;
+        GridSpawn spawn;
+        spawn.column = column;
+        spawn.targetRow = row;
+        spawn.spawnRow = front;
+        spawn.color = color;
+        spawns.append(spawn);
+    }
+}
+
+quint64 GridSimulation::forbiddenColors(const GridBoard &board, int row, int column)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    const auto cell = [&board, rows, columns](int r, int c) {
+        return (r >= 0 && r < rows && c >= 0 && c < columns) ? board.at(r, c) : GridBoard::EmptyCell;
+    };
+
+    const quint8 left1 = cell(row, column - 1);
+    const quint8 right1 = cell(row, column + 1);
+    const quint8 up1 = cell(row - 1, column);
+    const quint8 down1 = cell(row + 1, column);
+    return pairBit(left1, cell(row, column - 2)) | pairBit(right1, cell(row, column + 2))
+        | pairBit(left1, right1) | pairBit(up1, cell(row - 2, column))
+        | pairBit(down1, cell(row + 2, column)) | pairBit(up1, down1);
+}
+
+quint8 GridSimulation::pickSpawn(const GridBoard &board, int row, int column, GridSpawnStream &spawns)
+{
+    if (!spawns.isValid() || column >= spawns.columnCount())
+        return GridBoard::EmptyCell;
+    return spawns.nextExcluding(column, forbiddenColors(board, row, column));
+}
+
+bool GridSimulation::generateBoard(GridBoard &board, GridSpawnStream &spawns)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    if (!board.isValid() || !spawns.isValid() || spawns.columnCount() < columns)
+        return false;
+    board.fill(GridBoard::EmptyCell);
+
+    // X X . / . . X: swapping the lone X up completes the row, and the
+    // other two cells of the plant never form a run on their own. The
+    // transposed plant covers boards only two columns wide.
+    bool planted = false;
+    if (rows >= 2 && columns >= 3) {
+        const int row = int(spawns.nextBelow(0, quint32(rows - 1)));
+        const int column = int(spawns.nextBelow(0, quint32(columns - 2)));
+        const quint8 color = spawns.next(column);
+        board.set(row, column, color);
+        board.set(row, column + 1, color);
+        board.set(row + 1, column + 2, color);
+        planted = true;
+    } else if (rows >= 3 && columns >= 2) {
+        const int row = int(spawns.nextBelow(0, quint32(rows - 2)));
+        const int column = int(spawns.nextBelow(0, quint32(columns - 1)));
+        const quint8 color = spawns.next(column);
+        board.set(row, column, color);
+        board.set(row + 1, column, color);
+        board.set(row + 2, column + 1, color);
+        planted = true;
+    }
+
+    // The forbidden mask of each new cell covers every run of three through
+    // it, so runs can only appear when a cell has no allowed color left.
+    bool clean = true;
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            if (!board.isEmpty(row, column))
+                continue;
+            const quint64 forbidden = forbiddenColors(board, row, column);
+            const quint8 color = spawns.nextExcluding(column, forbidden);
+            if (color <= GridSpawnStream::MaxColors && ((forbidden >> (color - 1)) & 1u))
+                clean = false;
+            board.set(row, column, color);
+        }
+    }
+    return planted && clean;
+}
+
+int GridSimulation::swapScore(GridBoard &board, int row1, int column1, int row2, int column2)
+{
+    const quint8 first = board.at(row1, column1);
+    const quint8 second = board.at(row2, column2);
+    if (first == second || first == GridBoard::EmptyCell || second == GridBoard::EmptyCell)
+        return 0;
+
+    // The two cells end up with different colors, so the runs through each
+    // of them never share a cell and their counts simply add up.
+    board.swapCells(row1, column1, row2, column2);
+    const int score = matchedCellsThrough(board, row1, column1) + matchedCellsThrough(board, row2, column2);
+    board.swapCells(row1, column1, row2, column2);
+    return score;
+}
+
+void GridSimulation::rankSwaps(GridBoard &board, int limit, QList<GridSwap> &swaps)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    const auto consider = [&board, &swaps](int row1, int column1, int row2, int column2) {
+        const int score = swapScore(board, row1, column1, row2, column2);
+        if (score <= 0)
+            return;
+        GridSwap swap;
+        swap.row1 = row1;
+        swap.column1 = column1;
+        swap.row2 = row2;
+        swap.column2 = column2;
+        swap.score = score;
+        swaps.append(swap);
+    };
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            if (column + 1 < columns)
+                consider(row, column, row, column + 1);
+            if (row + 1 < rows)
+                consider(row, column, row + 1, column);
+        }
+    }
+
+    sortSwaps(swaps, limit);
+}
+
+void GridSimulation::sortSwaps(QList<GridSwap> &swaps, int limit)
+{
+    // Ties keep scan order, so the first swap found wins.
+    const auto better = [](const GridSwap &a, const GridSwap &b) { return a.score > b.score; };
+    std::stable_sort(swaps.begin(), swaps.end(), better);
+    if (limit > 0 && limit < swaps.size())
+        swaps.resize(limit);
+}
+
+int GridSimulation::matchedCellsThrough(const GridBoard &board, int row, int column)
+{
+    const int rows = board.rowCount();
+    const int columns = board.columnCount();
+    const quint8 color = board.at(row, column);
+    const quint8 *cells = board.rowData(row);
+
+    int horizontal = 1;
+    for (int c = column - 1; c >= 0 && cells[c] == color; --c)
+        ++horizontal;
+    for (int c = column + 1; c < columns && cells[c] == color; ++c)
+        ++horizontal;
+
+    int vertical = 1;
+    for (int r = row - 1; r >= 0 && board.at(r, column) == color; --r)
+        ++vertical;
+    for (int r = row + 1; r < rows && board.at(r, column) == color; ++r)
+        ++vertical;
+
+    int matched = 0;
+    if (horizontal >= 3)
+        matched += horizontal;
+    if (vertical >= 3)
+        matched += vertical;
+    if (horizontal >= 3 && vertical >= 3)
+        --matched;
+    return matched;
+}
+
+void GridSimulation::setCell(int row, int column, quint8 value)
+{
+    m_board.set(row, column, value);
+    m_tracker.markCellDirty(row, column);
+}
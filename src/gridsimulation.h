@@ -0,0 +1,96 @@
+#ifndef GRIDSIMULATION_H
+#define GRIDSIMULATION_H
+
+#include "gridboard.h"
+#include "gridinstructions.h"
+#include "gridmatchtracker.h"
+#include "gridspawnstream.h"
+
+#include <QList>
+#include <QVector>
+
+// Self-contained copy of the grid rules: a board and the spawn stream with
+// its position. Settling runs compact -> fill -> match -> launch until the
+// board is stable, exactly like the orchestrator does for the live board.
+// Plain value type with no QObject ties, so copies can be searched on
+// worker threads.
+class GridSimulation
+{
+public:
+    // Width of the column bands large-board work is split into.
+    static constexpr int BandColumns = 64;
+
+    GridSimulation() = default;
+    GridSimulation(const GridBoard &board, const GridSpawnStream &spawns, int fillDirection);
+
+    const GridBoard &board() const { return m_board; }
+    const GridSpawnStream &spawns() const { return m_spawns; }
+    int fillDirection() const { return m_fillDirection; }
+    // Board hash combined with the spawn counters. Two simulations of the
+    // same game with equal hashes play out the same from here on.
+    quint64 stateHash() const { return m_board.hash() ^ m_spawns.positionHash(); }
+
+    // Launch rounds performed by the last settle().
+    int cascadeDepth() const { return m_depth; }
+
+    // Large-board mode: compaction, filling and match updates run in bands
+    // on GridParallel, and filling drops every spawn straight into its
+    // final cell in one step instead of topping up the front row once per
+    // empty row. Results do not depend on the core count, but the spawned
+    // colors differ from the row-by-row fill.
+    bool isLargeBoard() const { return m_largeBoard; }
+    void setLargeBoard(bool largeBoard) { m_largeBoard = largeBoard; }
+
+    void swap(int row1, int column1, int row2, int column2);
+
+    // Adjacent swaps that create a match, best first; see rankSwaps().
+    void legalSwaps(int limit, QList<GridSwap> &swaps) { rankSwaps(m_board, limit, swaps); }
+
+    // Returns the number of cells launched. When timeline is given, every
+    // spawn, move, match and launch is appended to it with its step index.
+    int settle(QList<GridCascadeEvent> *timeline = nullptr);
+
+    static int frontRow(const GridBoard &board, int fillDirection);
+    static bool rowHasVacancy(const GridBoard &board, int row);
+    static void compact(GridBoard &board, int fillDirection, QList<GridMove> &moves, bool parallel = false);
+    // Bit color - 1 is set for every color that would complete a run of
+    // three through (row, column): both neighbours on one side, or one on
+    // each side, already share it. Colors above 64 are never reported.
+    static quint64 forbiddenColors(const GridBoard &board, int row, int column);
+    // Draws among the colors forbiddenColors() allows, in proportion to
+    // their spawn weights.
+    static quint8 pickSpawn(const GridBoard &board, int row, int column, GridSpawnStream &spawns);
+    // Fills every cell of board from spawns without creating a match, after
+    // planting one swap that does (three cells of one color in an L), so
+    // the result always has a move. O(cells). Returns false when the board
+    // is too small for the plant or a palette too small to avoid matches
+    // forced one anyway.
+    static bool generateBoard(GridBoard &board, GridSpawnStream &spawns);
+
+    // Cells in the matches an adjacent swap would create, judged from the
+    // runs through the two swapped cells only. The board is restored.
+    static int swapScore(GridBoard &board, int row1, int column1, int row2, int column2);
+    static void rankSwaps(GridBoard &board, int limit, QList<GridSwap> &swaps);
+    // Best first, ties in scan order; keeps the best limit (all if <= 0).
+    static void sortSwaps(QList<GridSwap> &swaps, int limit);
+
+private:
+    static void compactColumns(quint8 *const *rows, int rowCount, int firstColumn, int lastColumn,
+                               int fillDirection, QList<GridMove> &moves);
+    static int matchedCellsThrough(const GridBoard &board, int row, int column);
+    bool fillVacancies(QList<GridSpawn> &spawns);
+    void fillColumn(quint8 *const *rows, int column, QList<GridSpawn> &spawns);
+    void setCell(int row, int column, quint8 value);
+
+    GridBoard m_board;
+    GridSpawnStream m_spawns;
+    int m_fillDirection = 1;
+    int m_depth = 0;
+    bool m_largeBoard = false;
+    GridMatchTracker m_tracker;
+    QList<GridMove> m_moves;
+    QList<GridMatch> m_matches;
+    QList<GridSpawn> m_spawned;
+};
+
+#endif // GRIDSIMULATION_H
@@ -0,0 +1,165 @@
+#include "gridspawnstream.h"
+
+#include <QtAlgorithms>
+
+namespace {
+static const quint64 kGoldenGamma = 0x9e3779b97f4a7c15ull;
+
+quint64 splitMix64(quint64 z)
+{
+    z += kGoldenGamma;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+}
+
+GridSpawnStream::GridSpawnStream(quint32 seed, int colorCount, int columnCount)
+    : m_seed(seed)
+{
+    setColorCount(colorCount);
+    m_positions.fill(0u, qMax(0, columnCount));
+}
+
+void GridSpawnStream::setSeed(quint32 seed)
+{
+    m_seed = seed;
+    rewind();
+}
+
+void GridSpawnStream::setColorCount(int colorCount)
+{
+    setWeights(QVector<quint32>(qMax(0, colorCount), 1u));
+}
+
+void GridSpawnStream::setWeights(const QVector<quint32> &weights)
+{
+    m_table = GridAliasTable(weights.mid(0, MaxColors));
+}
+
+void GridSpawnStream::setColumnCount(int columnCount)
+{
+    m_positions.resize(qMax(0, columnCount));
+}
+
+void GridSpawnStream::rewind()
+{
+    m_positions.fill(0u);
+}
+
+quint64 GridSpawnStream::bits(int column, quint32 index) const
+{
+    const quint64 key = splitMix64((quint64(m_seed) << 32) | quint32(column));
+    return splitMix64(key + quint64(index) * kGoldenGamma);
+}
+
+quint32 GridSpawnStream::nextBelow(int column, quint32 bound)
+{
+    if (bound == 0)
+        return 0;
+    quint32 value = 0;
+    quint32 &position = m_positions[column];
+    while (!scale(bits(column, position++), bound, value)) {
+    }
+    return value;
+}
+
+void GridSpawnStats::merge(const GridSpawnStats &other)
+{
+    draws += other.draws;
+    redraws += other.redraws;
+    fallbacks += other.fallbacks;
+    for (int color = 0; color < GridSpawnStream::MaxColors; ++color)
+        colors[color] += other.colors[color];
+}
+
+quint8 GridSpawnStream::nextExcluding(int column, quint64 excluded)
+{
+    const quint8 color = next(column);
+    if (m_stats)
+        ++m_stats->draws;
+    if (!((excluded >> (color - 1)) & 1u)) {
+        if (m_stats)
+            ++m_stats->colors[color - 1];
+        return color;
+    }
+
+    // The first draw landed on an excluded color. Redrawing over the
+    // remaining weight alone makes the overall result exactly the
+    // weighted distribution restricted to the allowed colors.
+    const int colors = colorCount();
+    quint32 allowed = m_table.totalWeight();
+    for (quint64 bits = excluded; bits; bits &= bits - 1) {
+        const int index = qCountTrailingZeroBits(bits);
+        if (index >= colors)
+            break;
+        allowed -= m_table.weight(index);
+    }
+    if (allowed == 0) {
+        if (m_stats) {
+            ++m_stats->fallbacks;
+            ++m_stats->colors[color - 1];
+        }
+        return color;
+    }
+
+    // Map the offset among the allowed slices onto the full weight line by
+    // stepping over the excluded slices below it, lowest first.
+    quint32 offset = nextBelow(column, allowed);
+    for (quint64 bits = excluded; bits; bits &= bits - 1) {
+        const int index = qCountTrailingZeroBits(bits);
+        if (index >= colors || m_table.start(index) > offset)
+            break;
+        offset += m_table.weight(index);
+    }
+    const int index = m_table.locate(offset);
+    if (m_stats) {
+        ++m_stats->redraws;
+        ++m_stats->colors[index];
+    }
+    return static_cast<quint8>(index + 1);
+}
+
+QVector<quint8> GridSpawnStream::peek(int column, int count) const
+{
+    QVector<quint8> colors;
+    if (!m_table.isValid() || count <= 0)
+        return colors;
+    colors.reserve(count);
+    quint32 position = m_positions.at(column);
+    const quint32 bound = m_table.range();
+    while (colors.size() < count) {
+        quint32 value = 0;
+        if (scale(bits(column, position++), bound, value))
+            colors.append(static_cast<quint8>(m_table.sample(value) + 1));
+    }
+    return colors;
+}
+
+quint64 GridSpawnStream::positionHash() const
+{
+    quint64 hash = 0;
+    for (int column = 0; column < m_positions.size(); ++column)
+        hash ^= splitMix64((quint64(quint32(column)) << 32) | m_positions.at(column));
+    return hash;
+}
+
+void GridSpawnStream::setPositions(const QVector<quint32> &positions)
+{
+    const int columns = m_positions.size();
+    m_positions = positions;
+    m_positions.resize(columns);
+}
+
+bool GridSpawnStream::scale(quint64 bits, quint32 bound, quint32 &value)
+{
+    const quint64 product = (bits >> 32) * quint64(bound);
+    const quint32 low = quint32(product);
+    if (low < bound) {
+        const quint32 threshold = quint32(-bound) % bound;
+        if (low < threshold)
+            return false;
+    }
+    value = quint32(product >> 32);
+    return true;
+}
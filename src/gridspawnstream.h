@@ -0,0 +1,94 @@
+#ifndef GRIDSPAWNSTREAM_H
+#define GRIDSPAWNSTREAM_H
+
+#include "gridaliastable.h"
+
+#include <QtGlobal>
+#include <QVector>
+
+struct GridSpawnStats;
+
+// Counter-based spawn colors. Draw n of a column is a pure function of
+// (seed, column, n) run through the SplitMix64 finalizer, so any draw can be
+// computed or peeked without generating the ones before it. Each column
+// keeps its own counter; that is the whole stream state, and a column's
+// sequence does not depend on how many columns the board has. Bounded
+// draws use Lemire's multiply-shift with rejection, so they are exactly
+// uniform; a rejected draw simply consumes the next counter. Colors are
+// drawn in proportion to their weights through an alias table.
+class GridSpawnStream
+{
+public:
+    // Colors are reported as bits of a quint64, see nextExcluding().
+    static constexpr int MaxColors = 64;
+
+    GridSpawnStream() = default;
+    GridSpawnStream(quint32 seed, int colorCount, int columnCount);
+
+    quint32 seed() const { return m_seed; }
+    int colorCount() const { return m_table.size(); }
+    int columnCount() const { return m_positions.size(); }
+    bool isValid() const { return m_table.isValid() && !m_positions.isEmpty(); }
+    const GridAliasTable &weights() const { return m_table; }
+
+    void setSeed(quint32 seed);
+    // Equal weights for colorCount colors.
+    void setColorCount(int colorCount);
+    // One weight per color; the color count follows the list, capped at
+    // MaxColors. Weights are capped at GridAliasTable::MaxWeight.
+    void setWeights(const QVector<quint32> &weights);
+    // Keeps the counters of columns that still exist.
+    void setColumnCount(int columnCount);
+    void rewind();
+
+    quint64 bits(int column, quint32 index) const;
+    quint32 nextBelow(int column, quint32 bound);
+
+    // Next 1-based color of a column over the whole palette.
+    quint8 next(int column) { return static_cast<quint8>(m_table.sample(nextBelow(column, m_table.range())) + 1); }
+    // Next color among those whose bit (color - 1) is clear in excluded,
+    // still in proportion to their weights. Falls back to next() when
+    // every weighted color is excluded.
+    quint8 nextExcluding(int column, quint64 excluded);
+    // The next count colors next() would return, without consuming them.
+    QVector<quint8> peek(int column, int count) const;
+
+    quint32 position(int column) const { return m_positions.at(column); }
+    const QVector<quint32> &positions() const { return m_positions; }
+    // Hash of the column counters, for keying positions that also depend
+    // on what spawns next.
+    quint64 positionHash() const;
+    void setPositions(const QVector<quint32> &positions);
+    // Unshares the counters so next() can run for different columns on
+    // different threads.
+    void detach() { m_positions.detach(); }
+
+    // Counts every nextExcluding() draw into stats, which copies of the
+    // stream share. Not thread-safe, so leave it unset for large boards.
+    GridSpawnStats *stats() const { return m_stats; }
+    void setStats(GridSpawnStats *stats) { m_stats = stats; }
+
+private:
+    static bool scale(quint64 bits, quint32 bound, quint32 &value);
+
+    quint32 m_seed = 1u;
+    GridAliasTable m_table;
+    QVector<quint32> m_positions;
+    GridSpawnStats *m_stats = nullptr;
+};
+
+// Tallies of the colors nextExcluding() handed out. A redraw is a first
+// draw that landed on an excluded color and was drawn again among the
+// allowed ones; a fallback is a draw where every weighted color was
+// excluded, so the spawn completes a match.
+struct GridSpawnStats
+{
+    quint64 draws = 0;
+    quint64 redraws = 0;
+    quint64 fallbacks = 0;
+    quint64 colors[GridSpawnStream::MaxColors] = {};
+
+    void merge(const GridSpawnStats &other);
+};
+
+#endif // GRIDSPAWNSTREAM_H
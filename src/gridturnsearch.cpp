@@ -0,0 +1,190 @@
+#include "gridturnsearch.h"
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace {
+// Follow-up swaps tried below the first one, best local score first.
+static const int kSearchBranching = 6;
+}
+
+class GridTurnSearch::Task : public QRunnable
+{
+public:
+    Task(const QSharedPointer<GridTurnSearch> &search, int rootIndex)
+        : m_search(search)
+        , m_rootIndex(rootIndex)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        m_search->searchFrom(m_rootIndex);
+        m_search->finishTask();
+    }
+
+private:
+    QSharedPointer<GridTurnSearch> m_search;
+    int m_rootIndex;
+};
+
+GridTurnSearch::GridTurnSearch(const GridSimulation &root, int swapCount, int budgetMs)
+    : m_root(root)
+    , m_swapCount(qMax(1, swapCount))
+    , m_budgetMs(budgetMs)
+{
+    m_clock.start();
+    m_root.legalSwaps(0, m_rootSwaps);
+    m_visited.resize(m_swapCount);
+
+    // Until a task reports back, the best immediate swap is the answer.
+    if (!m_rootSwaps.isEmpty()) {
+        m_best.swaps.append(m_rootSwaps.first());
+        m_best.score = m_rootSwaps.first().score;
+        m_bestRoot = 0;
+        m_bestProvisional = true;
+    }
+}
+
+void GridTurnSearch::start(const QSharedPointer<GridTurnSearch> &search, QThreadPool *pool, Callback done)
+{
+    search->m_done = std::move(done);
+    const int tasks = search->m_rootSwaps.size();
+    if (tasks == 0) {
+        search->m_pending.storeRelaxed(1);
+        search->finishTask();
+        return;
+    }
+
+    search->m_pending.storeRelaxed(tasks);
+    for (int i = 0; i < tasks; ++i)
+        pool->start(new Task(search, i));
+}
+
+GridTurnPlan GridTurnSearch::run(const GridSimulation &root, int swapCount, int budgetMs)
+{
+    GridTurnSearch search(root, swapCount, budgetMs);
+    for (int i = 0; i < search.m_rootSwaps.size(); ++i)
+        search.searchFrom(i);
+    return search.bestPlan();
+}
+
+void GridTurnSearch::cancel()
+{
+    m_cancelled.storeRelaxed(1);
+}
+
+void GridTurnSearch::waitForDone()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_finished)
+        m_finishedCondition.wait(&m_mutex);
+}
+
+GridTurnPlan GridTurnSearch::bestPlan() const
+{
+    QMutexLocker locker(&m_mutex);
+    GridTurnPlan plan = m_best;
+    plan.nodes = m_nodes.loadRelaxed();
+    return plan;
+}
+
+void GridTurnSearch::searchFrom(int rootIndex)
+{
+    if (expired())
+        return;
+
+    const GridSwap &first = m_rootSwaps.at(rootIndex);
+    GridSimulation simulation = m_root;
+    simulation.swap(first.row1, first.column1, first.row2, first.column2);
+    GridSwap played = first;
+    played.score = simulation.settle();
+    m_nodes.fetchAndAddRelaxed(1);
+
+    QList<GridSwap> path;
+    path.reserve(m_swapCount);
+    path.append(played);
+    explore(simulation, path, played.score, rootIndex);
+}
+
+void GridTurnSearch::explore(GridSimulation &simulation, QList<GridSwap> &path, int total, int rootIndex)
+{
+    offer(path, total, rootIndex);
+    if (path.size() >= m_swapCount || expired())
+        return;
+    if (!claim(simulation, path.size(), total, rootIndex))
+        return;
+
+    QList<GridSwap> candidates;
+    simulation.legalSwaps(kSearchBranching, candidates);
+    for (const GridSwap &candidate : std::as_const(candidates)) {
+        if (expired())
+            return;
+        GridSimulation child = simulation;
+        child.swap(candidate.row1, candidate.column1, candidate.row2, candidate.column2);
+        GridSwap played = candidate;
+        played.score = child.settle();
+        m_nodes.fetchAndAddRelaxed(1);
+
+        path.append(played);
+        explore(child, path, total + played.score, rootIndex);
+        path.removeLast();
+    }
+}
+
+void GridTurnSearch::offer(const QList<GridSwap> &path, int total, int rootIndex)
+{
+    QMutexLocker locker(&m_mutex);
+    // Ties go to the earlier root swap so results do not depend on which
+    // worker got there first.
+    const bool better = m_bestProvisional || total > m_best.score
+        || (total == m_best.score && rootIndex < m_bestRoot);
+    if (!better)
+        return;
+    m_best.swaps = path;
+    m_best.score = total;
+    m_bestRoot = rootIndex;
+    m_bestProvisional = false;
+}
+
+bool GridTurnSearch::claim(const GridSimulation &simulation, int depth, int total, int rootIndex)
+{
+    // Equal positions at equal depth have identical subtrees, so only the
+    // arrival that would win in offer() needs to search below. Ties go to
+    // the earlier root as there, and within one root to the first arrival.
+    QMutexLocker locker(&m_visitMutex);
+    QHash<quint64, Visit> &visited = m_visited[depth];
+    const quint64 key = simulation.stateHash();
+    if (visited.contains(key)) {
+        const Visit seen = visited.value(key);
+        if (seen.total > total || (seen.total == total && seen.rootIndex <= rootIndex))
+            return false;
+    }
+    Visit visit;
+    visit.total = total;
+    visit.rootIndex = rootIndex;
+    visited.insert(key, visit);
+    return true;
+}
+
+void GridTurnSearch::finishTask()
+{
+    if (m_pending.fetchAndAddOrdered(-1) != 1)
+        return;
+
+    if (m_done)
+        m_done(bestPlan());
+
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_finishedCondition.wakeAll();
+}
+
+bool GridTurnSearch::expired() const
+{
+    if (m_cancelled.loadRelaxed())
+        return true;
+    return m_budgetMs > 0 && m_clock.hasExpired(m_budgetMs);
+}
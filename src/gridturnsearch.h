@@ -0,0 +1,93 @@
+#ifndef GRIDTURNSEARCH_H
+#define GRIDTURNSEARCH_H
+
+#include "gridinstructions.h"
+#include "gridsimulation.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+#include <functional>
+
+class QThreadPool;
+
+// Best swap sequence found by a turn search. Each swap's score is the number
+// of cells its full cascade launched; score is their sum.
+struct GridTurnPlan
+{
+    QList<GridSwap> swaps;
+    int score = 0;
+    int nodes = 0;
+};
+
+// Lookahead search over whole turns. Every legal first swap becomes one task
+// on the thread pool; each task plays the swap and its cascade on its own
+// GridSimulation copy, then recurses into the best follow-up swaps until the
+// turn's swaps are used up or the deadline passes. The callback runs once,
+// on whichever worker finishes last, with the best plan seen so far.
+// Positions reached through different swap orders are recognised by their
+// GridSimulation::stateHash() and only the best-scoring arrival at each one
+// is explored further.
+class GridTurnSearch
+{
+public:
+    using Callback = std::function<void(const GridTurnPlan &plan)>;
+
+    // A budget of zero or less searches without a deadline.
+    GridTurnSearch(const GridSimulation &root, int swapCount, int budgetMs);
+
+    static void start(const QSharedPointer<GridTurnSearch> &search, QThreadPool *pool, Callback done);
+    // Searches every first swap in turn on the calling thread, for callers
+    // that already keep the pool busy with work of their own. The budget
+    // covers the whole search.
+    static GridTurnPlan run(const GridSimulation &root, int swapCount, int budgetMs);
+
+    void cancel();
+    void waitForDone();
+    GridTurnPlan bestPlan() const;
+
+private:
+    class Task;
+
+    struct Visit
+    {
+        int total = 0;
+        int rootIndex = 0;
+    };
+
+    void searchFrom(int rootIndex);
+    void explore(GridSimulation &simulation, QList<GridSwap> &path, int total, int rootIndex);
+    void offer(const QList<GridSwap> &path, int total, int rootIndex);
+    bool claim(const GridSimulation &simulation, int depth, int total, int rootIndex);
+    void finishTask();
+    bool expired() const;
+
+    GridSimulation m_root;
+    QList<GridSwap> m_rootSwaps;
+    int m_swapCount = 1;
+    int m_budgetMs = 0;
+    QElapsedTimer m_clock;
+    QAtomicInt m_cancelled;
+    QAtomicInt m_pending;
+    QAtomicInt m_nodes;
+    Callback m_done;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_finishedCondition;
+    bool m_finished = false;
+    GridTurnPlan m_best;
+    int m_bestRoot = -1;
+    // The fallback seeded before any plan completes. Its score is the root
+    // swap's local score, not a settled total, so any offered plan wins.
+    bool m_bestProvisional = false;
+
+    QMutex m_visitMutex;
+    QVector<QHash<quint64, Visit>> m_visited;
+};
+
+#endif // GRIDTURNSEARCH_H
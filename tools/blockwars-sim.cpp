@@ -0,0 +1,253 @@
+// Headless cascade statistics. Every board is generated from its own seed
+// and played for a number of turns with the best-ranked swap, each swap
+// settled through GridSimulation exactly as the orchestrator would. Boards
+// are split into fixed bands on GridParallel, so the report for a given
+// set of options is the same on any core count.
+#include "gridboard.h"
+#include "gridinstructions.h"
+#include "gridparallel.h"
+#include "gridsimulation.h"
+#include "gridspawnstream.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThreadPool>
+
+namespace {
+static const int kBoardsPerBand = 256;
+// Cascade depths at or above the last bucket are counted together.
+static const int kDepthBuckets = 16;
+
+struct SimOptions
+{
+    int rows = 6;
+    int columns = 6;
+    int fillDirection = 1;
+    QVector<quint32> weights;
+    quint32 seed = 1u;
+    int boards = 100000;
+    int turns = 20;
+};
+
+struct SimStats
+{
+    quint64 boards = 0;
+    quint64 turns = 0;
+    quint64 launched = 0;
+    quint64 deadBoards = 0;
+    quint64 failedBoards = 0;
+    quint64 depths[kDepthBuckets] = {};
+    GridSpawnStats spawns;
+
+    void merge(const SimStats &other)
+    {
+        boards += other.boards;
+        turns += other.turns;
+        launched += other.launched;
+        deadBoards += other.deadBoards;
+        failedBoards += other.failedBoards;
+        for (int depth = 0; depth < kDepthBuckets; ++depth)
+            depths[depth] += other.depths[depth];
+        spawns.merge(other.spawns);
+    }
+};
+
+void simulateBoard(const SimOptions &options, int index, SimStats &stats, QList<GridSwap> &swaps)
+{
+    GridSpawnStream spawns(options.seed + quint32(index), 0, options.columns);
+    spawns.setWeights(options.weights);
+    spawns.setStats(&stats.spawns);
+    GridBoard board(options.rows, options.columns);
+    ++stats.boards;
+    if (!GridSimulation::generateBoard(board, spawns))
+        ++stats.failedBoards;
+
+    GridSimulation simulation(board, spawns, options.fillDirection);
+    for (int turn = 0; turn < options.turns; ++turn) {
+        swaps.clear();
+        simulation.legalSwaps(1, swaps);
+        if (swaps.isEmpty()) {
+            ++stats.deadBoards;
+            return;
+        }
+        const GridSwap &swap = swaps.first();
+        simulation.swap(swap.row1, swap.column1, swap.row2, swap.column2);
+        stats.launched += quint64(simulation.settle());
+        ++stats.turns;
+        ++stats.depths[qMin(simulation.cascadeDepth(), kDepthBuckets - 1)];
+    }
+}
+
+SimStats simulate(const SimOptions &options)
+{
+    const int bands = GridParallel::bandCount(options.boards, kBoardsPerBand);
+    QVector<SimStats> results(bands);
+    GridParallel::run(bands, [&options, &results](int band) {
+        SimStats &stats = results[band];
+        QList<GridSwap> swaps;
+        const int first = band * kBoardsPerBand;
+        const int last = qMin(options.boards, first + kBoardsPerBand);
+        for (int index = first; index < last; ++index)
+            simulateBoard(options, index, stats, swaps);
+    });
+
+    SimStats total;
+    for (const SimStats &stats : std::as_const(results))
+        total.merge(stats);
+    return total;
+}
+
+double ratio(quint64 part, quint64 whole)
+{
+    return whole ? double(part) / double(whole) : 0.0;
+}
+
+QJsonObject report(const SimOptions &options, const SimStats &stats, qint64 elapsedMs)
+{
+    const double seconds = qMax<qint64>(1, elapsedMs) / 1000.0;
+
+    QJsonArray depths;
+    for (int depth = 0; depth < kDepthBuckets; ++depth)
+        depths.append(double(stats.depths[depth]));
+    QJsonArray colors;
+    for (int color = 0; color < options.weights.size(); ++color)
+        colors.append(double(stats.spawns.colors[color]));
+
+    QJsonObject result;
+    result.insert(QStringLiteral("boards"), double(stats.boards));
+    result.insert(QStringLiteral("turns"), double(stats.turns));
+    result.insert(QStringLiteral("launched"), double(stats.launched));
+    result.insert(QStringLiteral("deadBoards"), double(stats.deadBoards));
+    result.insert(QStringLiteral("failedBoards"), double(stats.failedBoards));
+    result.insert(QStringLiteral("cascadeDepths"), depths);
+    result.insert(QStringLiteral("spawns"), double(stats.spawns.draws));
+    result.insert(QStringLiteral("spawnColors"), colors);
+    result.insert(QStringLiteral("redraws"), double(stats.spawns.redraws));
+    result.insert(QStringLiteral("fallbacks"), double(stats.spawns.fallbacks));
+    result.insert(QStringLiteral("elapsedMs"), double(elapsedMs));
+    result.insert(QStringLiteral("boardsPerSecond"), stats.boards / seconds);
+    result.insert(QStringLiteral("turnsPerSecond"), stats.turns / seconds);
+    return result;
+}
+
+void printReport(QTextStream &out, const SimOptions &options, const SimStats &stats, qint64 elapsedMs)
+{
+    const double seconds = qMax<qint64>(1, elapsedMs) / 1000.0;
+    out << "boards " << stats.boards << ", turns " << stats.turns << ", cells launched "
+        << stats.launched << '\n';
+    out << "dead boards " << stats.deadBoards << ", boards generated with a match "
+        << stats.failedBoards << '\n';
+
+    out << "cascade depth:\n";
+    for (int depth = 0; depth < kDepthBuckets; ++depth) {
+        if (!stats.depths[depth])
+            continue;
+        out << "  " << depth << (depth == kDepthBuckets - 1 ? "+" : "") << '\t' << stats.depths[depth]
+            << '\t' << QString::number(100.0 * ratio(stats.depths[depth], stats.turns), 'f', 3) << "%\n";
+    }
+
+    out << "spawn colors (" << stats.spawns.draws << " spawns):\n";
+    for (int color = 0; color < options.weights.size(); ++color) {
+        out << "  " << color << '\t' << stats.spawns.colors[color] << '\t'
+            << QString::number(100.0 * ratio(stats.spawns.colors[color], stats.spawns.draws), 'f', 3)
+            << "%\n";
+    }
+    out << "redraws " << stats.spawns.redraws << " ("
+        << QString::number(100.0 * ratio(stats.spawns.redraws, stats.spawns.draws), 'f', 3)
+        << "%), fallbacks " << stats.spawns.fallbacks << " ("
+        << QString::number(100.0 * ratio(stats.spawns.fallbacks, stats.spawns.draws), 'f', 4) << "%)\n";
+    out << "elapsed " << elapsedMs << " ms, " << QString::number(stats.boards / seconds, 'f', 0)
+        << " boards/s, " << QString::number(stats.turns / seconds, 'f', 0) << " turns/s\n";
+}
+
+bool parseWeights(const QString &text, QVector<quint32> &weights)
+{
+    weights.clear();
+    const QStringList parts = text.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool ok = false;
+        const uint weight = part.trimmed().toUInt(&ok);
+        if (!ok)
+            return false;
+        weights.append(qMin<quint32>(weight, GridAliasTable::MaxWeight));
+    }
+    return GridAliasTable(weights).isValid() && weights.size() <= GridSpawnStream::MaxColors;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("blockwars-sim"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Seeded fill and cascade statistics for Blockwars boards."));
+    parser.addHelpOption();
+    const QCommandLineOption boardsOption(QStringLiteral("boards"), QStringLiteral("Boards to play."),
+                                          QStringLiteral("count"), QStringLiteral("100000"));
+    const QCommandLineOption turnsOption(QStringLiteral("turns"), QStringLiteral("Swaps played per board."),
+                                         QStringLiteral("count"), QStringLiteral("20"));
+    const QCommandLineOption rowsOption(QStringLiteral("rows"), QStringLiteral("Board rows."),
+                                        QStringLiteral("count"), QStringLiteral("6"));
+    const QCommandLineOption columnsOption(QStringLiteral("columns"), QStringLiteral("Board columns, at most %1.").arg(GridSimulation::BandColumns),
+                                           QStringLiteral("count"), QStringLiteral("6"));
+    const QCommandLineOption fillOption(QStringLiteral("fill-direction"),
+                                        QStringLiteral("1 fills from the top, -1 from the bottom."),
+                                        QStringLiteral("direction"), QStringLiteral("1"));
+    const QCommandLineOption weightsOption(QStringLiteral("weights"),
+                                           QStringLiteral("Comma-separated relative spawn weights, one per color."),
+                                           QStringLiteral("list"), QStringLiteral("1,1,1,1"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the first board."),
+                                        QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"),
+                                           QStringLiteral("Worker threads; 0 uses every core."),
+                                           QStringLiteral("count"), QStringLiteral("0"));
+    const QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Print the report as JSON."));
+    parser.addOptions({ boardsOption, turnsOption, rowsOption, columnsOption, fillOption, weightsOption,
+                        seedOption, threadsOption, jsonOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    SimOptions options;
+    options.boards = parser.value(boardsOption).toInt();
+    options.turns = parser.value(turnsOption).toInt();
+    options.rows = parser.value(rowsOption).toInt();
+    options.columns = parser.value(columnsOption).toInt();
+    options.fillDirection = parser.value(fillOption).toInt() < 0 ? -1 : 1;
+    options.seed = parser.value(seedOption).toUInt();
+    if (options.boards <= 0 || options.turns < 0 || options.rows <= 0 || options.columns <= 0) {
+        err << "boards, rows and columns must be positive\n";
+        return 1;
+    }
+    // Wider boards fill their column bands in parallel, and the spawn
+    // counters shared by those bands are not thread-safe.
+    if (options.columns > GridSimulation::BandColumns) {
+        err << "columns must be at most " << GridSimulation::BandColumns << '\n';
+        return 1;
+    }
+    if (!parseWeights(parser.value(weightsOption), options.weights)) {
+        err << "weights must be 1 to " << GridSpawnStream::MaxColors
+            << " non-negative integers, at least one of them positive\n";
+        return 1;
+    }
+    const int threads = parser.value(threadsOption).toInt();
+    if (threads > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    QElapsedTimer clock;
+    clock.start();
+    const SimStats stats = simulate(options);
+    const qint64 elapsedMs = clock.elapsed();
+
+    QTextStream out(stdout);
+    if (parser.isSet(jsonOption))
+        out << QJsonDocument(report(options, stats, elapsedMs)).toJson();
+    else
+        printReport(out, options, stats, elapsedMs);
+    return 0;
+}
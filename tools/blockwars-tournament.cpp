@@ -0,0 +1,203 @@
+// Headless CPU-vs-CPU tournament. Two GridCpuPolicy configurations play
+// pairs of matches on the same seeds with sides exchanged, so board luck
+// cancels out; every match is one band on GridParallel. Reports win rates
+// and the wall time of each policy's decisions.
+#include "gridcpupolicy.h"
+#include "gridduel.h"
+#include "gridparallel.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <algorithm>
+
+namespace {
+struct PolicyTally
+{
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+    qint64 launched = 0;
+    int powerupsFired = 0;
+    QVector<qint64> decisionNs;
+};
+
+bool parsePolicy(const QString &text, GridCpuPolicy &policy)
+{
+    // lookaheadSwaps[:searchBudgetMs]
+    const QStringList parts = text.split(QLatin1Char(':'));
+    bool lookaheadOk = false;
+    bool budgetOk = true;
+    policy.lookaheadSwaps = parts.value(0).toInt(&lookaheadOk);
+    policy.searchBudgetMs = parts.size() > 1 ? parts.at(1).toInt(&budgetOk) : 0;
+    return lookaheadOk && budgetOk && parts.size() <= 2 && policy.lookaheadSwaps >= 1;
+}
+
+QString describe(const GridCpuPolicy &policy)
+{
+    if (policy.isGreedy())
+        return QStringLiteral("greedy");
+    return QStringLiteral("lookahead %1, %2 ms").arg(policy.lookaheadSwaps).arg(policy.searchBudgetMs);
+}
+
+double percentileMs(const QVector<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    const int index = qMin(sorted.size() - 1, int(fraction * sorted.size()));
+    return sorted.at(index) / 1.0e6;
+}
+
+QJsonObject policyReport(const GridCpuPolicy &policy, const PolicyTally &tally, int matches)
+{
+    QJsonObject latency;
+    latency.insert(QStringLiteral("p50"), percentileMs(tally.decisionNs, 0.50));
+    latency.insert(QStringLiteral("p90"), percentileMs(tally.decisionNs, 0.90));
+    latency.insert(QStringLiteral("p99"), percentileMs(tally.decisionNs, 0.99));
+    latency.insert(QStringLiteral("max"), percentileMs(tally.decisionNs, 1.0));
+
+    QJsonObject result;
+    result.insert(QStringLiteral("lookaheadSwaps"), policy.lookaheadSwaps);
+    result.insert(QStringLiteral("searchBudgetMs"), policy.searchBudgetMs);
+    result.insert(QStringLiteral("wins"), tally.wins);
+    result.insert(QStringLiteral("losses"), tally.losses);
+    result.insert(QStringLiteral("draws"), tally.draws);
+    result.insert(QStringLiteral("winRate"), matches ? double(tally.wins) / matches : 0.0);
+    result.insert(QStringLiteral("launched"), double(tally.launched));
+    result.insert(QStringLiteral("powerupsFired"), tally.powerupsFired);
+    result.insert(QStringLiteral("decisions"), tally.decisionNs.size());
+    result.insert(QStringLiteral("decisionMs"), latency);
+    return result;
+}
+
+void printPolicy(QTextStream &out, const QString &name, const GridCpuPolicy &policy, const PolicyTally &tally,
+                 int matches)
+{
+    out << name << " (" << describe(policy) << "): " << tally.wins << " wins, " << tally.losses << " losses, "
+        << tally.draws << " draws, win rate "
+        << QString::number(matches ? 100.0 * tally.wins / matches : 0.0, 'f', 1) << "%\n";
+    out << "  cells launched " << tally.launched << ", powerups fired " << tally.powerupsFired << '\n';
+    out << "  " << tally.decisionNs.size() << " decisions, ms p50 "
+        << QString::number(percentileMs(tally.decisionNs, 0.50), 'f', 3) << ", p90 "
+        << QString::number(percentileMs(tally.decisionNs, 0.90), 'f', 3) << ", p99 "
+        << QString::number(percentileMs(tally.decisionNs, 0.99), 'f', 3) << ", max "
+        << QString::number(percentileMs(tally.decisionNs, 1.0), 'f', 3) << '\n';
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("blockwars-tournament"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless CPU-vs-CPU matches between two policies."));
+    parser.addHelpOption();
+    const QCommandLineOption firstOption(QStringLiteral("a"),
+                                         QStringLiteral("First policy as lookaheadSwaps[:searchBudgetMs]."),
+                                         QStringLiteral("policy"), QStringLiteral("3:200"));
+    const QCommandLineOption secondOption(QStringLiteral("b"),
+                                          QStringLiteral("Second policy as lookaheadSwaps[:searchBudgetMs]."),
+                                          QStringLiteral("policy"), QStringLiteral("1"));
+    const QCommandLineOption pairsOption(QStringLiteral("pairs"),
+                                         QStringLiteral("Seeds to play; each is two matches with sides exchanged."),
+                                         QStringLiteral("count"), QStringLiteral("100"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the first pair."),
+                                        QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption swapsOption(QStringLiteral("max-swaps"), QStringLiteral("Swaps per turn."),
+                                         QStringLiteral("count"), QStringLiteral("3"));
+    const QCommandLineOption healthOption(QStringLiteral("health"), QStringLiteral("Starting health."),
+                                          QStringLiteral("hp"), QStringLiteral("250"));
+    const QCommandLineOption turnsOption(QStringLiteral("max-turns"),
+                                         QStringLiteral("Turns before the healthier side wins."),
+                                         QStringLiteral("count"), QStringLiteral("200"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"),
+                                           QStringLiteral("Matches played at once; 0 uses every core."),
+                                           QStringLiteral("count"), QStringLiteral("0"));
+    const QCommandLineOption jsonOption(QStringLiteral("json"), QStringLiteral("Print the report as JSON."));
+    parser.addOptions({ firstOption, secondOption, pairsOption, seedOption, swapsOption, healthOption,
+                        turnsOption, threadsOption, jsonOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    GridCpuPolicy policies[2];
+    if (!parsePolicy(parser.value(firstOption), policies[0])
+        || !parsePolicy(parser.value(secondOption), policies[1])) {
+        err << "policies are lookaheadSwaps[:searchBudgetMs] with a lookahead of at least 1\n";
+        return 1;
+    }
+    GridDuelRules rules;
+    rules.maxSwaps = parser.value(swapsOption).toInt();
+    rules.health = parser.value(healthOption).toInt();
+    rules.maxTurns = parser.value(turnsOption).toInt();
+    const int pairs = parser.value(pairsOption).toInt();
+    const quint32 seed = parser.value(seedOption).toUInt();
+    if (pairs <= 0 || rules.maxSwaps <= 0 || rules.health <= 0 || rules.maxTurns <= 0) {
+        err << "pairs, max-swaps, health and max-turns must be positive\n";
+        return 1;
+    }
+    const int threads = parser.value(threadsOption).toInt();
+    if (threads > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    // Match 2k + s plays seed pair k with policy s on side 0. Side 0 always
+    // moves first, so each policy gets the first move once per pair.
+    const int matches = pairs * 2;
+    QVector<GridDuelResult> results(matches);
+    QElapsedTimer clock;
+    clock.start();
+    GridParallel::run(matches, [&](int match) {
+        const int pair = match / 2;
+        const int swapped = match % 2;
+        const GridCpuPolicy seated[2] = { policies[swapped], policies[1 - swapped] };
+        const quint32 seeds[2] = { seed + quint32(pair) * 2u, seed + quint32(pair) * 2u + 1u };
+        results[match] = GridDuel::play(rules, seated, seeds, 0);
+    });
+    const qint64 elapsedMs = clock.elapsed();
+
+    PolicyTally tallies[2];
+    qint64 turns = 0;
+    for (int match = 0; match < matches; ++match) {
+        const GridDuelResult &result = results.at(match);
+        const int swapped = match % 2;
+        turns += result.turns;
+        for (int side = 0; side < 2; ++side) {
+            PolicyTally &tally = tallies[side == 0 ? swapped : 1 - swapped];
+            if (result.winner < 0)
+                ++tally.draws;
+            else if (result.winner == side)
+                ++tally.wins;
+            else
+                ++tally.losses;
+            tally.launched += result.launched[side];
+            tally.powerupsFired += result.powerupsFired[side];
+            tally.decisionNs += result.decisionNs[side];
+        }
+    }
+    for (PolicyTally &tally : tallies)
+        std::sort(tally.decisionNs.begin(), tally.decisionNs.end());
+
+    QTextStream out(stdout);
+    if (parser.isSet(jsonOption)) {
+        QJsonObject report;
+        report.insert(QStringLiteral("matches"), matches);
+        report.insert(QStringLiteral("meanTurns"), double(turns) / matches);
+        report.insert(QStringLiteral("elapsedMs"), double(elapsedMs));
+        report.insert(QStringLiteral("a"), policyReport(policies[0], tallies[0], matches));
+        report.insert(QStringLiteral("b"), policyReport(policies[1], tallies[1], matches));
+        out << QJsonDocument(report).toJson();
+        return 0;
+    }
+
+    out << matches << " matches, " << QString::number(double(turns) / matches, 'f', 1) << " turns on average, "
+        << elapsedMs << " ms\n";
+    printPolicy(out, QStringLiteral("a"), policies[0], tallies[0], matches);
+    printPolicy(out, QStringLiteral("b"), policies[1], tallies[1], matches);
+    return 0;
+}